@@ -1,7 +1,9 @@
 
 #include "./ztest/gui.hpp"
 #include <any>
+#include <charconv>
 #include <ctime>
+#include <unordered_map>
 int add(int a, int b) { return a + b; }
 double subtract(double a, double b) { return a - b; }
 ZTEST_F(ASSERTION, FailedEXPECT_EQ) {
@@ -30,6 +32,140 @@ ZTEST_F(ASSERTION, SuccessASSERT_TRUE) {
   ASSERT_TRUE(true);
   return ZState::z_success;
 }
+ZTEST_F(ASSERTION, SuccessASSERTInLambda) {
+  auto check = [&]() -> bool {
+    ASSERT_TRUE(add(1, 1) == 2);
+    return true;
+  };
+  ASSERT_TRUE(check());
+  return ZState::z_success;
+}
+ZTEST_F(ASSERTION, FailedASSERTInLambda) {
+  auto check = [&]() { ASSERT_EQ(5, add(2, 2)); };
+  check();
+  EXPECT_EQ(6, add(2, 3)); // lambda 中的 ASSERT 失败后同样终止测试，不会执行
+  return ZState::z_success;
+}
+ZTEST_F(ASSERTION, SuccessCOMPARISONS) {
+  EXPECT_NE(6, add(2, 3));
+  EXPECT_LT(add(2, 3), 6);
+  EXPECT_GE(add(2, 3), 5);
+  EXPECT_STREQ("ztest", std::string("ztest"));
+  EXPECT_FALSE(add(2, 3) == 6);
+  EXPECT_THROW(throw std::runtime_error("boom"), std::runtime_error);
+  EXPECT_NO_THROW(add(2, 3));
+  return ZState::z_success;
+}
+ZTEST_F(ASSERTION, FailedEXPECT_STREQ) {
+  EXPECT_STREQ("ztest", std::string("gtest"));
+  return ZState::z_success;
+}
+ZTEST_F(ASSERTION, SuccessARRAY) {
+  std::vector<double> expected(100000), actual(100000);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] = std::sin(i * 0.001);
+    actual[i] = std::nextafter(expected[i], 2.0);
+  }
+  EXPECT_ARRAY_NEAR(expected, actual, ZTolerance::ulps(1));
+  EXPECT_ARRAY_NEAR(expected, actual, 1e-12);
+  EXPECT_BYTES_EQ(std::string("ztest"), std::string_view("ztest"));
+  return ZState::z_success;
+}
+ZTEST_F(ASSERTION, FailedARRAY_EQ) {
+  std::vector<int> expected(100000, 1), actual(100000, 1);
+  actual[42] = 2;
+  actual[99999] = -7;
+  EXPECT_ARRAY_EQ(expected, actual);
+  return ZState::z_success;
+}
+// 快照 snapshots/add_table.txt.gz 随仓库提交，输出有意变化时以 --update-snapshots 重新生成
+ZTEST_F(ASSERTION, SuccessSNAPSHOT) {
+  std::string table;
+  for (int i = 0; i < 1000; ++i)
+    table += std::to_string(i) + " + " + std::to_string(i) + " = " +
+             std::to_string(add(i, i)) + "\n";
+  EXPECT_SNAPSHOT("add_table.txt.gz", table);
+  return ZState::z_success;
+}
+ZTEST_F(ASSERTION, FailedSoftEXPECT) {
+  EXPECT_EQ(6, add(2, 3));
+  EXPECT_GT(add(1, 1), 3);
+  ASSERT_TRUE(add(2, 2) == 5);
+  EXPECT_EQ(0, add(0, 0)); // ASSERT 失败后不会执行
+  return ZState::z_success;
+}
+ZTEST_PROPERTY(PROPERTY, AddCommutes, (int a, int b),
+               ZGen::integer<int>(-1000, 1000),
+               ZGen::integer<int>(-1000, 1000)) {
+  return add(a, b) == add(b, a);
+}
+// 故意失败：缩小后的反例为 ([0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0])
+ZTEST_PROPERTY(PROPERTY, FailedShortVectors, (std::vector<int> v),
+               ZGen::vector(ZGen::integer<int>(0, 100))) {
+  return v.size() <= 10;
+}
+// 模糊测试：--fuzz <秒> 时生成新输入，否则只回放 fuzz/FUZZ.IntRoundTrip 下的语料
+ZFUZZ(FUZZ, IntRoundTrip) {
+  std::string text(reinterpret_cast<const char *>(data), size);
+  int value = 0;
+  if (std::from_chars(text.data(), text.data() + text.size(), value).ec !=
+      std::errc())
+    return ZState::z_success;
+  EXPECT_EQ(value, std::stoi(std::to_string(value)));
+  return ZState::z_success;
+}
+// 共享夹具：两个测试共用一次构建的加法表，构建时间单独报告
+ZFIXTURE(AddLookupTable, std::vector<int>, run) {
+  auto table = std::make_shared<std::vector<int>>();
+  for (int i = 0; i < 1000; ++i)
+    table->push_back(add(i, i));
+  return table;
+}
+ZTEST_F(FIXTURE, TableEven) {
+  auto table = ZFixture::get<std::vector<int>>("AddLookupTable");
+  EXPECT_EQ(0, (*table)[21] % 2);
+  return ZState::z_success;
+}
+ZTEST_F(FIXTURE, TableSize) {
+  auto table = ZFixture::get<std::vector<int>>("AddLookupTable");
+  EXPECT_EQ(1000u, table->size());
+  return ZState::z_success;
+}
+ZTEST_USES_FIXTURE(FIXTURE, TableEven, "AddLookupTable");
+ZTEST_USES_FIXTURE(FIXTURE, TableSize, "AddLookupTable");
+// 依赖调度：Schema -> Load -> Query，Load 独占 "database" 锁
+ZTEST_F(SCHED, Schema) {
+  EXPECT_EQ(3, add(1, 2));
+  return ZState::z_success;
+}
+ZTEST_F(SCHED, Load) {
+  EXPECT_EQ(5, add(2, 3));
+  return ZState::z_success;
+}
+ZTEST_F(SCHED, Query) {
+  EXPECT_EQ(7, add(3, 4));
+  return ZState::z_success;
+}
+ZTEST_DEPENDS_ON(SCHED, Load, "SCHED.Schema");
+ZTEST_DEPENDS_ON(SCHED, Query, "SCHED.Load");
+ZTEST_LOCK(SCHED, Load, "database");
+ZTEST_SEMAPHORE(SCHED, Query, "connections", 4);
+// 并行套件：子测试在共享线程池上并行运行，结果按各自的名称记录
+namespace {
+struct ParallelSuiteRegistrar {
+  ParallelSuiteRegistrar() {
+    ZTestSuiteFactory::createSuite("SUITE.ParallelAdd", ZType::z_safe, "")
+        .parallel()
+        .addTest(TestFactory::createTest("SUITE.AddSmall", ZType::z_safe, "",
+                                         add, 1, 2)
+                     .setExpectedOutput(3))
+        .addTest(TestFactory::createTest("SUITE.AddLarge", ZType::z_safe, "",
+                                         add, 1000, 2000)
+                     .setExpectedOutput(3000))
+        .addToRegistry();
+  }
+} parallel_suite_registrar;
+} // namespace
 ZTEST_F(RUN, safe_test_single_case1, safe) {
   sleep(2);
   ASSERT_TRUE(true);
@@ -83,17 +219,96 @@ ZTEST_P_CSV(MathTests, AdditionTests, "data.csv") {
   EXPECT_EQ(actual, std::get<double>(expected));
   return ZState::z_success;
 }
+// data.zcol 由 data.csv 转换得到: test_gui --no-gui --convert-csv data.csv data.zcol
+ZTEST_P_COLUMNAR(MathTests, AdditionColumnarTests, "data.zcol") {
+  double actual = getInput<double>(0) + getInput<double>(1);
+  EXPECT_EQ(actual, getOutput<double>());
+  return ZState::z_success;
+}
 ZBENCHMARK(Vector, PushBack) {
   std::vector<int> v;
   for (int i = 0; i < 10000; ++i) {
     v.push_back(i);
   }
+  doNotOptimize(v.data());
+  clobberMemory();
   return ZState::z_success;
 }
+// 随机数的生成在 pauseTiming/resumeTiming 之间，只计 push_back
 ZBENCHMARK(Matrix, PushBack, 20000) {
   std::vector<int> v;
-  for (int i = 0; i < 1000; ++i) {
-    v.push_back(random());
+  pauseTiming();
+  std::vector<int> input(1000);
+  for (auto &x : input)
+    x = random();
+  resumeTiming();
+  for (int x : input) {
+    v.push_back(x);
+  }
+  doNotOptimize(v.data());
+  clobberMemory();
+  return ZState::z_success;
+}
+ZBENCHMARK_BYTES(Vector, PushBack, 10000 * sizeof(int));
+ZBENCHMARK_ITEMS(Vector, PushBack, 10000);
+// 每次迭代前重新打乱输入，打乱不计入排序时间
+static std::vector<int> sort_input;
+ZBENCHMARK(Vector, Sort, 2000) {
+  size_t comparisons = 0;
+  std::sort(sort_input.begin(), sort_input.end(), [&](int a, int b) {
+    ++comparisons;
+    return a < b;
+  });
+  addItems(sort_input.size());
+  addCounter("comparisons", comparisons);
+  doNotOptimize(sort_input.data());
+  clobberMemory();
+  return ZState::z_success;
+}
+ZBENCHMARK_BATCH_SETUP(Vector, Sort, 2000) { sort_input.resize(5000); }
+ZBENCHMARK_SETUP(Vector, Sort) {
+  for (auto &x : sort_input)
+    x = random();
+}
+// 浸泡测试：按时长运行3秒而不是固定次数，延迟记入固定大小的直方图，
+// 结束时检查 RSS 和延迟中位数是否随时间单调增长。缓存容量有上限，不应出现增长
+static std::unordered_map<uint64_t, uint64_t> soak_cache;
+ZBENCHMARK(Cache, BoundedInsert) {
+  static uint64_t next_key = 0;
+  const uint64_t key = next_key++;
+  soak_cache[key % 4096] = key;
+  doNotOptimize(soak_cache.size());
+  return ZState::z_success;
+}
+ZBENCHMARK_SOAK(Cache, BoundedInsert, 3);
+// 同一原子变量上的争用随线程数增加，效率曲线会明显下降
+static std::atomic<long> bench_counter{0};
+ZBENCHMARK_THREADS(Atomic, FetchAdd, 4, 100000) {
+  bench_counter.fetch_add(1, std::memory_order_relaxed);
+  return ZState::z_success;
+}
+// 首次调用时才构建查找表：热迭代中只出现一次，冷启动测试中每个样本都要付出
+static uint32_t lookup(uint32_t key) {
+  static const std::vector<uint32_t> table = [] {
+    std::vector<uint32_t> t(1 << 20);
+    for (uint32_t i = 0; i < t.size(); ++i)
+      t[i] = i * 2654435761u;
+    return t;
+  }();
+  return table[key & (table.size() - 1)];
+}
+ZBENCHMARK(Startup, LazyTable, 100) {
+  ZBenchMark::doNotOptimize(lookup(12345));
+  return ZState::z_success;
+}
+ZBENCHMARK_COLD_START(Startup, LazyTable, 8);
+// 模拟一个串行处理、每个请求约100微秒的服务，约10000请求/秒时饱和
+static std::mutex service_mutex;
+ZLOADTEST(Service, Handle, 1000, 16000) {
+  std::lock_guard<std::mutex> lock(service_mutex);
+  const auto until =
+      std::chrono::steady_clock::now() + std::chrono::microseconds(100);
+  while (std::chrono::steady_clock::now() < until) {
   }
   return ZState::z_success;
 }
@@ -112,7 +327,7 @@ int main(int argc, char *argv[]) {
   if (!testFilePath.empty()) {
     logger.setTestFilePath(testFilePath);
   }
-  ZDataRegistry::instance().setMaxSize(1);
+  ZDataRegistry::instance().setMemoryBudget(256 * 1024 * 1024);
   if (!runGui) {
     return runFromCLI(args, context);
   }
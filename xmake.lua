@@ -1,5 +1,10 @@
-add_requires("glfw", "imgui", "glad","implot","curl","nlohmann_json","libcurl")
+add_requires("glfw", "imgui", "glad","implot","curl","nlohmann_json","libcurl","zlib")
 add_requires("imgui 1.91.7-docking", {configs = {glfw_opengl3 = true}})
+option("fuzz")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Instrument test sources with SanitizerCoverage for ZFUZZ targets")
+option_end()
 target("test_gui")
     set_kind("binary")
     set_targetdir("build")
@@ -7,7 +12,7 @@ target("test_gui")
     add_packages("glfw")
     add_packages("imgui")
     add_packages("glad")
-    add_packages("implot","curl","nlohmann_json","libcurl")
+    add_packages("implot","curl","nlohmann_json","libcurl","zlib")
     add_files("*.cpp")
     add_files(
         "*.cpp",
@@ -19,5 +24,8 @@ target("test_gui")
         "./ztest/lib/implot" 
     )
     add_links("curl")
+    if has_config("fuzz") then
+        add_files("*.cpp", {cxflags = "-fsanitize-coverage=trace-pc"})
+    end
     set_toolchains("gcc")
     set_languages("c++20")
@@ -0,0 +1,192 @@
+#pragma once
+#include "ztest_logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+// 线程池和基准测试的 CPU 亲和性设置。
+// 绑定后的工作线程首次写入的内存按 Linux 默认的 first-touch 策略分配在其所在的
+// NUMA 节点上，线程作用域的夹具（ZFixtureScope::z_thread）因此天然是节点本地的。
+// 为基准测试保留的核心不分配给工作线程。
+
+struct ZAffinityOptions {
+  size_t workers = 0;        // 共享线程池的线程数，0 表示 min(硬件线程数, 8)
+  bool pin_workers = false;  // 每个工作线程绑定到一个 CPU，按 NUMA 节点交错分配
+  int benchmark_core = -1;   // 基准测试独占的 CPU，-1 表示不保留
+  bool raise_priority = false; // 基准测试期间提高调度优先级
+};
+
+class ZAffinity {
+public:
+  static ZAffinityOptions &options() {
+    static ZAffinityOptions opts;
+    return opts;
+  }
+  /**
+   * @description: 共享线程池的线程数
+   */
+  static size_t workerCount() {
+    if (options().workers > 0)
+      return options().workers;
+    return std::max(1u, std::min(std::thread::hardware_concurrency(), 8u));
+  }
+  /**
+   * @description: 进程允许运行的 CPU 列表
+   */
+  static std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        if (CPU_ISSET(cpu, &set))
+          cpus.push_back(cpu);
+    }
+    if (cpus.empty())
+      for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu)
+        cpus.push_back(static_cast<int>(cpu));
+    return cpus;
+  }
+  /**
+   * @description: CPU 所在的 NUMA 节点，无法确定时为0
+   */
+  static int nodeOf(int cpu) {
+    std::error_code ec;
+    const std::string dir =
+        "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    for (const auto &entry : std::filesystem::directory_iterator(dir, ec)) {
+      const std::string name = entry.path().filename().string();
+      if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+          std::all_of(name.begin() + 4, name.end(), ::isdigit))
+        return std::stoi(name.substr(4));
+    }
+    return 0;
+  }
+  /**
+   * @description: 当前线程所在的 NUMA 节点
+   */
+  static int currentNode() {
+    const int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : nodeOf(cpu);
+  }
+  /**
+   * @description: 工作线程可用的 CPU（排除基准测试保留的核心），
+   *               按 NUMA 节点交错排列，使少量工作线程也能分布到所有节点
+   */
+  static std::vector<int> workerCpus() {
+    std::map<int, std::vector<int>> by_node;
+    for (int cpu : allowedCpus())
+      if (cpu != options().benchmark_core)
+        by_node[nodeOf(cpu)].push_back(cpu);
+    std::vector<int> out;
+    for (size_t i = 0;; ++i) {
+      bool any = false;
+      for (auto &[node, cpus] : by_node) {
+        if (i < cpus.size()) {
+          out.push_back(cpus[i]);
+          any = true;
+        }
+      }
+      if (!any)
+        break;
+    }
+    return out;
+  }
+  /**
+   * @description: 在第 index 个工作线程上调用，按选项设置其亲和性
+   */
+  static void applyWorker(size_t index) {
+    const auto &opts = options();
+    if (!opts.pin_workers && opts.benchmark_core < 0)
+      return;
+    const std::vector<int> cpus = workerCpus();
+    if (cpus.empty()) {
+      if (index == 0)
+        logger.warning("No CPU left for workers besides the benchmark core; "
+                       "workers are not pinned");
+      return;
+    }
+    if (opts.pin_workers)
+      setCurrentThread({cpus[index % cpus.size()]});
+    else
+      setCurrentThread(cpus); // 只排除保留的核心
+  }
+  /**
+   * @description: 设置当前线程的 CPU 亲和性
+   * @return 设置成功返回true
+   */
+  static bool setCurrentThread(const std::vector<int> &cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+      CPU_SET(cpu, &set);
+    const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0)
+      logger.warning("pthread_setaffinity_np failed: " +
+                     std::string(std::strerror(rc)));
+    return rc == 0;
+  }
+};
+
+// ZPinnedScope 在作用域内把当前线程绑定到一个 CPU，可选地提高调度优先级，
+// 退出时恢复原来的亲和性和优先级。cpu 为负时什么都不做。
+class ZPinnedScope {
+public:
+  ZPinnedScope(int cpu, bool raise_priority) {
+    if (cpu >= 0) {
+      _restore_affinity =
+          pthread_getaffinity_np(pthread_self(), sizeof(_affinity),
+                                 &_affinity) == 0;
+      ZAffinity::setCurrentThread({cpu});
+    }
+    if (raise_priority)
+      raise();
+  }
+  ~ZPinnedScope() {
+    if (_fifo)
+      pthread_setschedparam(pthread_self(), _policy, &_param);
+    if (_niced)
+      setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), _nice);
+    if (_restore_affinity)
+      pthread_setaffinity_np(pthread_self(), sizeof(_affinity), &_affinity);
+  }
+  ZPinnedScope(const ZPinnedScope &) = delete;
+  ZPinnedScope &operator=(const ZPinnedScope &) = delete;
+
+private:
+  // 先尝试 SCHED_FIFO 的最低实时优先级，没有权限时退回到 nice -10
+  void raise() {
+    pthread_getschedparam(pthread_self(), &_policy, &_param);
+    sched_param fifo{};
+    fifo.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &fifo) == 0) {
+      _fifo = true;
+      return;
+    }
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    errno = 0;
+    _nice = getpriority(PRIO_PROCESS, tid);
+    if (errno == 0 && setpriority(PRIO_PROCESS, tid, -10) == 0) {
+      _niced = true;
+      return;
+    }
+    logger.warning("Cannot raise benchmark priority (needs CAP_SYS_NICE)");
+  }
+
+  cpu_set_t _affinity;
+  bool _restore_affinity = false;
+  int _policy = SCHED_OTHER;
+  sched_param _param{};
+  bool _fifo = false;
+  int _nice = 0;
+  bool _niced = false;
+};
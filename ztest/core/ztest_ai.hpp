@@ -0,0 +1,333 @@
+#pragma once
+#include "ztest_cluster.hpp"
+#include "ztest_logger.hpp"
+#include "ztest_result.hpp"
+#include "ztest_utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+// AI分析请求：提示词之外附带结构化的统计和失败信息，供离线后端直接使用
+struct ZAIRequest {
+  std::string prompt;
+  ZResultTally summary;
+  std::vector<ZFailureBucket> failures; // 按错误特征分组的失败
+};
+
+// AI分析后端接口，analyze 失败时抛出异常，结果不会被缓存；
+// cancelled 在进程退出时被置为 true，耗时的后端应尽快返回
+class ZAIBackend {
+public:
+  virtual ~ZAIBackend() = default;
+  virtual std::string name() const = 0;
+  virtual std::string analyze(const ZAIRequest &request,
+                              std::chrono::milliseconds timeout,
+                              const std::atomic<bool> &cancelled) = 0;
+};
+
+// 通过 DashScope HTTP 接口调用 Qwen 模型
+class ZQwenBackend : public ZAIBackend {
+public:
+  explicit ZQwenBackend(std::string api_key, std::string model = "qwen-turbo")
+      : _api_key(std::move(api_key)), _model(std::move(model)) {}
+
+  std::string name() const override { return "qwen:" + _model; }
+  std::string analyze(const ZAIRequest &request,
+                      std::chrono::milliseconds timeout,
+                      const std::atomic<bool> &cancelled) override {
+    std::string text = call_qwen_api(request.prompt, _api_key, _model, 0.7,
+                                     static_cast<long>(timeout.count()),
+                                     &cancelled);
+    // call_qwen_api 以返回值报告错误，这里转换为异常以免错误被缓存
+    for (const char *prefix : {"CURL error", "HTTP error", "JSON parse error",
+                               "JSON type error", "Error:",
+                               "Failed to initialize CURL"}) {
+      if (text.rfind(prefix, 0) == 0)
+        throw std::runtime_error(text);
+    }
+    return text;
+  }
+
+private:
+  std::string _api_key;
+  std::string _model;
+};
+
+// 离线启发式后端：不访问网络，根据失败信息生成简要的 markdown 分析
+class ZHeuristicBackend : public ZAIBackend {
+public:
+  std::string name() const override { return "heuristic"; }
+  std::string analyze(const ZAIRequest &request, std::chrono::milliseconds,
+                      const std::atomic<bool> &) override {
+    const auto &summary = request.summary;
+    std::ostringstream out;
+    out << "**离线分析**（未使用在线模型）\n\n";
+    out << "- 总测试用例: " << summary.total << "，通过: " << summary.passed
+        << "，失败: " << summary.failed << "\n";
+    if (summary.total > 0) {
+      char rate[16];
+      std::snprintf(rate, sizeof(rate), "%.1f%%",
+                    summary.passed * 100.0 / summary.total);
+      out << "- 通过率: " << rate << "\n";
+    }
+    if (request.failures.empty()) {
+      out << "\n所有测试均已通过，未发现需要处理的失败。\n";
+      return out.str();
+    }
+
+    std::map<std::string, size_t> by_suite;
+    size_t mismatches = 0, tolerances = 0, exceptions = 0;
+    for (const auto &bucket : request.failures) {
+      for (const auto &name : bucket.tests)
+        by_suite[ZTestResultManager::suiteOf(name)]++;
+      if (bucket.pattern.find("near") != std::string::npos)
+        tolerances += bucket.count();
+      else if (bucket.pattern.find("Expected") != std::string::npos)
+        mismatches += bucket.count();
+      else
+        exceptions += bucket.count();
+    }
+
+    out << "\n### 失败分布\n";
+    for (const auto &[suite, count] : by_suite)
+      out << "- " << suite << ": " << count << "\n";
+
+    out << "\n### 失败分组\n";
+    for (const auto &bucket : request.failures) {
+      // 错误信息折叠为单行，连续空白合并为一个空格
+      std::string line;
+      for (char c : bucket.example) {
+        bool space = c == '\n' || c == ' ' || c == '\t';
+        if (!space)
+          line += c;
+        else if (!line.empty() && line.back() != ' ')
+          line += ' ';
+      }
+      out << "- " << bucket.count() << " 个用例，如 `" << *bucket.tests.begin()
+          << "`: " << line << "\n";
+    }
+    if (request.failures.size() < summary.failed)
+      out << "\n" << summary.failed << " 个失败归并为 "
+          << request.failures.size() << " 个分组，多个用例很可能共享同一缺陷。\n";
+
+    out << "\n### 建议\n";
+    if (mismatches > 0)
+      out << "- " << mismatches
+          << " 个断言期望值与实际值不一致，检查被测逻辑或期望值是否过时。\n";
+    if (tolerances > 0)
+      out << "- " << tolerances
+          << " 个近似比较超出容差，确认容差是否与数值精度匹配。\n";
+    if (exceptions > 0)
+      out << "- " << exceptions
+          << " 个失败来自异常或其它错误，优先排查这些用例。\n";
+    return out.str();
+  }
+};
+
+// ZAIAnalyzer 管理AI分析后端、按提示词内容寻址的结果缓存和超时。
+// 未配置 DASHSCOPE_API_KEY 时自动使用离线后端，不会抛出异常。
+class ZAIAnalyzer {
+public:
+  static ZAIAnalyzer &instance() {
+    static ZAIAnalyzer analyzer;
+    return analyzer;
+  }
+  /**
+   * @description: 设置分析后端，传入空指针时恢复按环境变量自动选择
+   */
+  void setBackend(std::shared_ptr<ZAIBackend> backend) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _backend = std::move(backend);
+  }
+  std::shared_ptr<ZAIBackend> backend() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_backend) {
+      const char *key = std::getenv("DASHSCOPE_API_KEY");
+      if (key && *key)
+        _backend = std::make_shared<ZQwenBackend>(key);
+      else
+        _backend = std::make_shared<ZHeuristicBackend>();
+    }
+    return _backend;
+  }
+  void setTimeout(std::chrono::milliseconds timeout) { _timeout = timeout; }
+  std::chrono::milliseconds getTimeout() const { return _timeout; }
+  /**
+   * @description: 设置缓存目录，为空时不缓存
+   */
+  void setCacheDir(const std::string &dir) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cache_dir = dir;
+  }
+  /**
+   * @description: 异步发起分析，缓存命中时返回已就绪的结果
+   * @param request 分析请求
+   * @param on_done 结果就绪后在分析线程上调用，可为空
+   * @return 分析结果，失败时为错误说明
+   */
+  std::shared_future<std::string>
+  analyzeAsync(ZAIRequest request,
+               std::function<void(const std::string &)> on_done = nullptr) {
+    auto active = backend();
+    const std::string path = cachePath(*active, request.prompt);
+    std::promise<std::string> promise;
+    auto result = promise.get_future().share();
+
+    if (!path.empty()) {
+      std::ifstream cached(path);
+      if (cached) {
+        logger.debug("AI analysis cache hit: " + path);
+        std::string text(std::istreambuf_iterator<char>(cached),
+                         std::istreambuf_iterator<char>{});
+        promise.set_value(text);
+        if (on_done)
+          on_done(text);
+        return result;
+      }
+    }
+    // 在分析器持有的线程上执行，超时的请求不阻塞调用方；退出时取消并等待
+    auto finished = std::make_shared<std::atomic<bool>>(false);
+    std::thread worker([this, active, request = std::move(request), path,
+                        timeout = _timeout.load(), finished,
+                        on_done = std::move(on_done),
+                        promise = std::move(promise)]() mutable {
+      std::string text;
+      try {
+        text = active->analyze(request, timeout, _cancelled);
+        if (!path.empty())
+          store(path, text);
+      } catch (const std::exception &e) {
+        if (!_cancelled)
+          logger.warning("AI analysis (" + active->name() +
+                         ") failed: " + e.what());
+        text = std::string("AI分析失败: ") + e.what();
+      }
+      promise.set_value(text);
+      if (on_done && !_cancelled)
+        on_done(text);
+      *finished = true;
+    });
+    std::lock_guard<std::mutex> lock(_workers_mutex);
+    reapLocked();
+    _workers.push_back({std::move(worker), std::move(finished)});
+    return result;
+  }
+  /**
+   * @description: 发起分析并在超时时间内等待结果
+   * @param request 分析请求
+   * @param on_late 超时后结果才返回时在分析线程上调用，用于补写报告；可为空
+   * @return 分析结果；超时或失败时为说明文字
+   */
+  std::string analyze(ZAIRequest request,
+                      std::function<void(const std::string &)> on_late =
+                          nullptr) {
+    // 超时与结果返回可能同时发生，由 mutex 决定结果交给哪一方
+    struct Handoff {
+      std::mutex mutex;
+      bool abandoned = false;
+      bool done = false;
+      std::string text;
+    };
+    auto handoff = std::make_shared<Handoff>();
+    auto pending = analyzeAsync(
+        std::move(request),
+        [handoff, on_late = std::move(on_late)](const std::string &text) {
+          std::unique_lock<std::mutex> lock(handoff->mutex);
+          handoff->done = true;
+          if (!handoff->abandoned)
+            return;
+          lock.unlock();
+          logger.info("Late AI analysis arrived; updating the report");
+          if (on_late)
+            on_late(text);
+        });
+    if (pending.wait_for(_timeout.load()) != std::future_status::ready) {
+      std::lock_guard<std::mutex> lock(handoff->mutex);
+      if (!handoff->done) {
+        handoff->abandoned = true;
+        logger.warning("AI analysis timed out after " +
+                       std::to_string(_timeout.load().count()) + " ms");
+        return "AI分析超时";
+      }
+    }
+    return pending.get();
+  }
+  /**
+   * @description: 取消进行中的分析并等待分析线程结束，析构时自动调用
+   */
+  void shutdown() {
+    _cancelled = true;
+    std::vector<Worker> workers;
+    {
+      std::lock_guard<std::mutex> lock(_workers_mutex);
+      workers.swap(_workers);
+    }
+    for (auto &worker : workers)
+      worker.thread.join();
+  }
+
+private:
+  struct Worker {
+    std::thread thread;
+    std::shared_ptr<std::atomic<bool>> finished;
+  };
+
+  ZAIAnalyzer() = default;
+  ~ZAIAnalyzer() { shutdown(); }
+
+  // 回收已结束的分析线程
+  void reapLocked() {
+    for (auto it = _workers.begin(); it != _workers.end();) {
+      if (*it->finished) {
+        it->thread.join();
+        it = _workers.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  std::string cachePath(const ZAIBackend &backend, const std::string &prompt) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_cache_dir.empty())
+      return "";
+    uint64_t key = fnv1a64(prompt, fnv1a64(backend.name()));
+    return _cache_dir + "/" + hashToHex(key) + ".md";
+  }
+  /**
+   * @description: 原子地写入缓存文件（先写临时文件再重命名）
+   */
+  static void store(const std::string &path, const std::string &text) {
+    std::error_code ec;
+    std::filesystem::create_directories(
+        std::filesystem::path(path).parent_path(), ec);
+    const std::string tmp = path + ".tmp";
+    {
+      std::ofstream out(tmp, std::ios::trunc);
+      if (!out)
+        return;
+      out << text;
+    }
+    std::filesystem::rename(tmp, path, ec);
+  }
+
+  std::mutex _mutex;
+  std::shared_ptr<ZAIBackend> _backend;
+  std::atomic<std::chrono::milliseconds> _timeout{std::chrono::seconds(30)};
+  std::string _cache_dir = ".ztest_ai_cache";
+  std::atomic<bool> _cancelled{false};
+  std::mutex _workers_mutex;
+  std::vector<Worker> _workers;
+};
@@ -0,0 +1,428 @@
+#pragma once
+#include "ztest_error.hpp"
+#include "ztest_types.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+class ZTestBase;
+// 致命断言（ASSERT_*）失败的处理方式，非致命断言（EXPECT_*）总是记录后继续执行
+// z_throw : 记录后格式化并抛出 ZTestFailureException（默认）
+// z_record: 只记录到线程局部的预分配缓冲区，抛出不带信息的 ZFatalAssertion，
+//           报告时才格式化错误信息，失败路径上标量不分配内存
+enum class ZAssertMode { z_throw, z_record };
+
+enum class ZAssertOp : uint8_t {
+  z_eq,
+  z_ne,
+  z_lt,
+  z_le,
+  z_gt,
+  z_ge,
+  z_near,
+  z_streq,
+  z_true,
+  z_false,
+  z_throw,
+  z_no_throw,
+  z_array_eq,
+  z_array_near,
+  z_bytes_eq,
+  z_snapshot
+};
+
+// 断言中捕获的原始值，字符串等内容复制到缓冲区的字符池中
+struct ZAssertValue {
+  enum class Kind : uint8_t { z_none, z_int, z_uint, z_float, z_bool, z_char,
+                              z_ptr, z_text };
+  Kind kind = Kind::z_none;
+  union {
+    int64_t i;
+    uint64_t u;
+    double f;
+    bool b;
+    char c;
+    const void *p;
+    struct {
+      uint32_t offset;
+      uint32_t length;
+    } text;
+  };
+  ZAssertValue() : u(0) {}
+};
+
+// 合并到 ZTestResult 中的结构化失败信息
+struct ZTestFailure {
+  std::string file;       // 为空表示失败来自断言之外的异常
+  int line = 0;
+  std::string expression; // 断言宏及其参数，如 EXPECT_EQ(a, b)
+  std::string message;
+  bool fatal = false;
+};
+
+struct ZAssertRecord {
+  const std::string *test_name;
+  const char *file;
+  int line;
+  ZAssertOp op;
+  bool fatal;
+  const char *lhs_expr;
+  const char *rhs_expr;
+  ZAssertValue lhs, rhs, tolerance;
+};
+
+// ZAssertBuffer 是每个线程一份的预分配断言记录缓冲区，
+// 由 ZAssertScope 在测试开始时清空并绑定到正在运行的测试。
+class ZAssertBuffer {
+public:
+  static constexpr size_t kMaxRecords = 64;
+  static constexpr size_t kArenaSize = 4096;
+
+  static ZAssertBuffer &current() {
+    thread_local ZAssertBuffer buffer;
+    return buffer;
+  }
+  static void setMode(ZAssertMode mode) { modeRef() = mode; }
+  static ZAssertMode getMode() { return modeRef(); }
+
+  bool bound() const { return _depth > 0; }
+  const ZTestBase *owner() const { return _owner; }
+  size_t size() const { return _count; }
+  size_t dropped() const { return _dropped; }
+  const ZAssertRecord &operator[](size_t i) const { return _records[i]; }
+  /**
+   * @description: 报告一次断言失败，非致命断言记录后返回，致命断言记录后抛出
+   */
+  template <typename A, typename B, typename T = int>
+  void fail(ZAssertOp op, bool fatal, const char *file, int line,
+            const char *lhs_expr, const char *rhs_expr, const A &lhs,
+            const B &rhs, const T &tolerance = T{}) {
+    const size_t arena_mark = _arena_used;
+    ZAssertRecord rec{&ownerName(), file,   line,     op,
+                      fatal,      lhs_expr, rhs_expr, {},
+                      {},         {}};
+    rec.lhs = capture(lhs);
+    rec.rhs = capture(rhs);
+    rec.tolerance = capture(tolerance);
+    // 未绑定测试时没有调用方会收集记录，退回抛异常
+    if (!bound()) {
+      std::string message = format(rec);
+      _arena_used = arena_mark; // 释放临时占用的字符池
+      throw ZTestFailureException(std::move(message));
+    }
+    if (_count < kMaxRecords)
+      _records[_count++] = rec;
+    else
+      _dropped++;
+    if (!fatal)
+      return;
+    _fatal_thrown = true;
+    if (getMode() == ZAssertMode::z_throw)
+      throw ZTestFailureException(format(rec));
+    throw ZFatalAssertion();
+  }
+  /**
+   * @description: 当前绑定的测试名，未绑定时为占位名（定义在 ztest_base.hpp）
+   */
+  const std::string &ownerName() const;
+  /**
+   * @description: 将当前绑定的测试标记为不可缓存（定义在 ztest_base.hpp）
+   */
+  void markOwnerUncacheable() const;
+  /**
+   * @description: 格式化单条记录，与 ZTestFailureException 的格式一致
+   */
+  std::string format(const ZAssertRecord &rec) const {
+    std::string expected, actual;
+    auto value = [this](const ZAssertValue &v) { return toString(v); };
+    switch (rec.op) {
+    case ZAssertOp::z_eq:
+    case ZAssertOp::z_array_eq:
+    case ZAssertOp::z_array_near:
+    case ZAssertOp::z_bytes_eq:
+    case ZAssertOp::z_snapshot:
+      expected = value(rec.lhs);
+      actual = value(rec.rhs);
+      break;
+    case ZAssertOp::z_near:
+      expected = "Expected value near " + value(rec.lhs) + " ± " +
+                 value(rec.tolerance);
+      actual = "Actual value was " + value(rec.rhs) +
+               " (diff = " + value(diff(rec.lhs, rec.rhs)) + ")";
+      break;
+    case ZAssertOp::z_streq:
+      expected = "\"" + value(rec.lhs) + "\"";
+      actual = "\"" + value(rec.rhs) + "\"";
+      break;
+    case ZAssertOp::z_true:
+    case ZAssertOp::z_false:
+      expected = rec.op == ZAssertOp::z_true ? "true" : "false";
+      actual = std::string(rec.op == ZAssertOp::z_true ? "false" : "true") +
+               " ( " + rec.lhs_expr + " )";
+      break;
+    case ZAssertOp::z_throw:
+      expected = std::string(rec.lhs_expr) + " throws " + rec.rhs_expr;
+      actual = value(rec.lhs);
+      break;
+    case ZAssertOp::z_no_throw:
+      expected = std::string(rec.lhs_expr) + " does not throw";
+      actual = "threw " + value(rec.lhs);
+      break;
+    default:
+      expected = std::string(rec.lhs_expr) + " " + opText(rec.op) + " " +
+                 rec.rhs_expr;
+      actual = value(rec.lhs) + " vs " + value(rec.rhs);
+    }
+    return "Test Failure in " + *rec.test_name + ":\n  Expected: " + expected +
+           "\n  Actual  : " + actual;
+  }
+  /**
+   * @description: 还原断言宏的调用文本，如 EXPECT_EQ(a, b)
+   */
+  static std::string expression(const ZAssertRecord &rec) {
+    static constexpr const char *names[] = {
+        "EQ",   "NE",    "LT",   "LE",    "GT",    "GE",
+        "NEAR", "STREQ", "TRUE", "FALSE", "THROW", "NO_THROW",
+        "ARRAY_EQ", "ARRAY_NEAR", "BYTES_EQ", "SNAPSHOT"};
+    std::string out = rec.fatal ? "ASSERT_" : "EXPECT_";
+    out += names[static_cast<size_t>(rec.op)];
+    out += "(";
+    out += rec.lhs_expr;
+    if (*rec.rhs_expr) {
+      out += ", ";
+      out += rec.rhs_expr;
+    }
+    out += ")";
+    return out;
+  }
+  /**
+   * @description: 格式化所有记录，每条附带文件和行号
+   */
+  std::string formatAll() const {
+    std::string out;
+    for (size_t i = 0; i < _count; ++i) {
+      if (i)
+        out += "\n";
+      out += format(_records[i]);
+      out += "\n  at ";
+      out += _records[i].file;
+      out += ":" + std::to_string(_records[i].line);
+    }
+    if (_dropped)
+      out += "\n(" + std::to_string(_dropped) + " more failures not recorded)";
+    return out;
+  }
+
+private:
+  friend class ZAssertScope;
+
+  static std::atomic<ZAssertMode> &modeRef() {
+    static std::atomic<ZAssertMode> mode{ZAssertMode::z_throw};
+    return mode;
+  }
+
+  void reset() {
+    _count = _dropped = 0;
+    _arena_used = 0;
+    _fatal_thrown = false;
+  }
+
+  template <typename T> ZAssertValue capture(const T &v) {
+    using U = std::decay_t<T>;
+    ZAssertValue out;
+    if constexpr (std::is_same_v<U, bool>) {
+      out.kind = ZAssertValue::Kind::z_bool;
+      out.b = v;
+    } else if constexpr (std::is_same_v<U, char>) {
+      out.kind = ZAssertValue::Kind::z_char;
+      out.c = v;
+    } else if constexpr (std::is_enum_v<U>) {
+      out.kind = ZAssertValue::Kind::z_int;
+      out.i = static_cast<int64_t>(v);
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+      out.kind = ZAssertValue::Kind::z_int;
+      out.i = v;
+    } else if constexpr (std::is_integral_v<U>) {
+      out.kind = ZAssertValue::Kind::z_uint;
+      out.u = v;
+    } else if constexpr (std::is_floating_point_v<U>) {
+      out.kind = ZAssertValue::Kind::z_float;
+      out.f = v;
+    } else if constexpr (std::is_same_v<U, const char *> ||
+                         std::is_same_v<U, char *>) {
+      store(out, v ? std::string_view(v) : std::string_view("(null)"));
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      store(out, std::string_view(v));
+    } else if constexpr (std::is_pointer_v<U> ||
+                         std::is_null_pointer_v<U>) {
+      out.kind = ZAssertValue::Kind::z_ptr;
+      out.p = v;
+    } else if constexpr (requires(std::ostream &os) { os << v; }) {
+      // 自定义类型只能在失败时立即格式化
+      std::ostringstream oss;
+      oss << v;
+      store(out, oss.str());
+    } else {
+      store(out, "<" + std::to_string(sizeof(U)) + "-byte object>");
+    }
+    return out;
+  }
+
+  void store(ZAssertValue &out, std::string_view text) {
+    size_t room = kArenaSize - _arena_used;
+    size_t length = std::min(text.size(), room);
+    std::memcpy(_arena.data() + _arena_used, text.data(), length);
+    out.kind = ZAssertValue::Kind::z_text;
+    out.text = {static_cast<uint32_t>(_arena_used),
+                static_cast<uint32_t>(length)};
+    _arena_used += length;
+  }
+
+  static ZAssertValue diff(const ZAssertValue &a, const ZAssertValue &b) {
+    ZAssertValue out;
+    out.kind = ZAssertValue::Kind::z_float;
+    out.f = std::abs(asFloat(a) - asFloat(b));
+    return out;
+  }
+
+  static double asFloat(const ZAssertValue &v) {
+    switch (v.kind) {
+    case ZAssertValue::Kind::z_int:
+      return v.i;
+    case ZAssertValue::Kind::z_uint:
+      return v.u;
+    case ZAssertValue::Kind::z_float:
+      return v.f;
+    default:
+      return 0;
+    }
+  }
+
+  std::string toString(const ZAssertValue &v) const {
+    char buf[64];
+    switch (v.kind) {
+    case ZAssertValue::Kind::z_int:
+      return std::string(buf, std::to_chars(buf, buf + sizeof(buf), v.i).ptr);
+    case ZAssertValue::Kind::z_uint:
+      return std::string(buf, std::to_chars(buf, buf + sizeof(buf), v.u).ptr);
+    case ZAssertValue::Kind::z_float:
+      // 与 ostream 默认格式一致（6位有效数字）
+      std::snprintf(buf, sizeof(buf), "%g", v.f);
+      return buf;
+    case ZAssertValue::Kind::z_bool:
+      return v.b ? "true" : "false";
+    case ZAssertValue::Kind::z_char:
+      return std::string(1, v.c);
+    case ZAssertValue::Kind::z_ptr:
+      std::snprintf(buf, sizeof(buf), "%p", v.p);
+      return buf;
+    case ZAssertValue::Kind::z_text:
+      return std::string(_arena.data() + v.text.offset, v.text.length);
+    default:
+      return "";
+    }
+  }
+
+  static const char *opText(ZAssertOp op) {
+    switch (op) {
+    case ZAssertOp::z_ne:
+      return "!=";
+    case ZAssertOp::z_lt:
+      return "<";
+    case ZAssertOp::z_le:
+      return "<=";
+    case ZAssertOp::z_gt:
+      return ">";
+    case ZAssertOp::z_ge:
+      return ">=";
+    default:
+      return "==";
+    }
+  }
+
+  std::array<ZAssertRecord, kMaxRecords> _records;
+  std::array<char, kArenaSize> _arena;
+  size_t _count = 0;
+  size_t _dropped = 0;
+  size_t _arena_used = 0;
+  int _depth = 0;
+  const ZTestBase *_owner = nullptr;
+  bool _fatal_thrown = false; // 最后一条记录已作为异常抛出
+};
+
+// ZAssertScope 在测试运行期间把当前线程的断言缓冲区绑定到该测试，
+// 嵌套作用域（套件中的子测试、等待期间代为执行的其它测试）有独立的记录，
+// 退出时恢复外层作用域的记录。
+class ZAssertScope {
+public:
+  explicit ZAssertScope(const ZTestBase &test)
+      : _buffer(ZAssertBuffer::current()), _outer(_buffer._owner) {
+    if (_buffer._depth++ > 0)
+      _saved = std::make_unique<ZAssertBuffer>(_buffer);
+    _buffer.reset();
+    _buffer._owner = &test;
+  }
+  ~ZAssertScope() {
+    if (_saved) {
+      _buffer._records = _saved->_records;
+      _buffer._arena = _saved->_arena;
+      _buffer._count = _saved->_count;
+      _buffer._dropped = _saved->_dropped;
+      _buffer._arena_used = _saved->_arena_used;
+      _buffer._fatal_thrown = _saved->_fatal_thrown;
+    }
+    _buffer._depth--;
+    _buffer._owner = _outer;
+  }
+  ZAssertScope(const ZAssertScope &) = delete;
+  ZAssertScope &operator=(const ZAssertScope &) = delete;
+
+  bool failed() const { return _buffer.size() > 0 || _buffer.dropped() > 0; }
+  /**
+   * @description: 记录到的失败使返回成功的测试变为失败
+   */
+  ZState finalState(ZState state) const {
+    return failed() ? ZState::z_failed : state;
+  }
+  /**
+   * @description: 格式化记录到的失败，可追加一条异常信息
+   */
+  std::string message(const std::string &extra = "") const {
+    std::string out = _buffer.formatAll();
+    if (!extra.empty() && !_buffer._fatal_thrown)
+      out += out.empty() ? extra : "\n" + extra;
+    return out;
+  }
+  /**
+   * @description: 转换为结构化失败列表
+   * @param extra 断言之外的异常信息，非空时作为最后一条致命失败
+   */
+  std::vector<ZTestFailure> failures(const std::string &extra = "") const {
+    std::vector<ZTestFailure> out;
+    out.reserve(_buffer.size() + 1);
+    for (size_t i = 0; i < _buffer.size(); ++i) {
+      const auto &rec = _buffer[i];
+      out.push_back({rec.file, rec.line, ZAssertBuffer::expression(rec),
+                     _buffer.format(rec), rec.fatal});
+    }
+    if (!extra.empty() && !_buffer._fatal_thrown)
+      out.push_back({"", 0, "", extra, true});
+    return out;
+  }
+
+private:
+  ZAssertBuffer &_buffer;
+  const ZTestBase *_outer;
+  std::unique_ptr<ZAssertBuffer> _saved; // 嵌套时外层作用域的记录
+};
@@ -1,10 +1,19 @@
 #pragma once
+#include "ztest_assert.hpp"
 #include "ztest_types.hpp"
 #include <bits/unique_ptr.h>
 #include <functional>
 #include <string>
+#include <vector>
 
 using namespace std;
+class ZTestResult;
+// 测试运行期间占用的命名资源：互斥锁占用全部容量，计数信号量占用一个单位
+struct ZResourceClaim {
+  string name;
+  size_t capacity; // 资源的总容量
+  bool exclusive;
+};
 // ZtestInterface接口,定义了必须实现的方法。
 class ZTestInterface {
 public:
@@ -25,6 +34,11 @@ private:
   vector<function<void()>> _before_all_hooks;
   vector<function<void()>> _after_each_hooks;
   vector<function<void()>> _after_all_hooks;
+  vector<string> _data_files;
+  vector<string> _dependencies;
+  vector<ZResourceClaim> _resources;
+  vector<string> _fixtures;
+  mutable bool _uncacheable = false; // 运行中读取了缓存键之外的文件
 
 public:
   ZTestBase(string name, ZType type, string description)
@@ -47,6 +61,91 @@ public:
   virtual void setDescription(string description) {
     _description = description;
   }
+  /**
+   * @description: 声明测试依赖的数据文件，文件内容参与结果缓存的键计算
+   * @param path 数据文件路径
+   * @return 当前测试用例对象的引用
+   */
+  virtual ZTestBase &addDataFile(const string &path) {
+    _data_files.push_back(path);
+    return *this;
+  }
+  /**
+   * @description: 获取测试依赖的数据文件
+   * @return 数据文件路径列表
+   */
+  const vector<string> &getDataFiles() const { return _data_files; }
+  /**
+   * @description: 声明本测试在另一个测试通过之后才能运行
+   * @param name 被依赖测试的全名（Suite.Test）
+   * @return 当前测试用例对象的引用
+   */
+  virtual ZTestBase &dependsOn(const string &name) {
+    _dependencies.push_back(name);
+    return *this;
+  }
+  const vector<string> &getDependencies() const { return _dependencies; }
+  /**
+   * @description: 声明运行时独占一个命名锁
+   * @param name 锁名
+   * @return 当前测试用例对象的引用
+   */
+  virtual ZTestBase &withLock(const string &name) {
+    _resources.push_back({name, 1, true});
+    return *this;
+  }
+  /**
+   * @description: 声明运行时占用计数信号量的一个单位
+   * @param name 信号量名
+   * @param capacity 信号量容量，即可同时运行的测试数
+   * @return 当前测试用例对象的引用
+   */
+  virtual ZTestBase &withSemaphore(const string &name, size_t capacity) {
+    _resources.push_back({name, capacity, false});
+    return *this;
+  }
+  const vector<ZResourceClaim> &getResources() const { return _resources; }
+  /**
+   * @description: 声明本测试使用的共享夹具，最后一个声明者结束后夹具被释放
+   * @param name 夹具名
+   * @return 当前测试用例对象的引用
+   */
+  virtual ZTestBase &useFixture(const string &name) {
+    _fixtures.push_back(name);
+    return *this;
+  }
+  const vector<string> &getFixtures() const { return _fixtures; }
+  /**
+   * @description: 将测试运行产生的附加信息写入结果，默认没有附加信息
+   * @param result 本次运行的结果
+   */
+  virtual void annotateResult(ZTestResult &) const {}
+  /**
+   * @description: 取出本次运行中子测试各自的结果（套件使用），默认没有子测试
+   * @param out 追加子测试结果的列表
+   */
+  virtual void takeChildResults(vector<ZTestResult> &) {}
+  /**
+   * @description: 通过的结果能否由结果缓存复用，默认除基准测试外都可以
+   */
+  virtual bool cacheable() const { return getType() != ZType::z_benchmark; }
+  /**
+   * @description: 标记测试在运行中读取了未用 addDataFile 声明的文件（如快照），
+   *               缓存键无法反映其内容，结果不再缓存
+   */
+  void markUncacheable() const { _uncacheable = true; }
+  bool isMarkedUncacheable() const { return _uncacheable; }
+  /**
+   * @description: 当前线程上本测试是否已有断言失败（含非致命的 EXPECT_*）
+   */
+  bool hasFailure() const {
+    const auto &buffer = ZAssertBuffer::current();
+    return buffer.owner() == this && (buffer.size() > 0 || buffer.dropped() > 0);
+  }
+  /**
+   * @description: 请求在后台预取测试所需的数据，默认无数据需要预取
+   */
+  virtual void prefetchData() {}
   /**
    * @description: 添加测试前的钩子函数
    * @param hook 要添加的钩子函数
@@ -98,4 +197,12 @@ public:
     _after_all_hooks.push_back(move(hook));
     return *this;
   }
-};
\ No newline at end of file
+};
+inline const std::string &ZAssertBuffer::ownerName() const {
+  static const std::string unbound = "(no running test)";
+  return _owner ? _owner->getName() : unbound;
+}
+inline void ZAssertBuffer::markOwnerUncacheable() const {
+  if (_owner)
+    _owner->markUncacheable();
+}
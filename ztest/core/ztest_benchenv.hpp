@@ -0,0 +1,175 @@
+#pragma once
+#include "ztest_affinity.hpp"
+#include "ztest_logger.hpp"
+#include "ztest_result.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+// 基准测试的运行环境探测：运行前读取调频策略、睿频、SMT 兄弟线程和负载，
+// 运行后比较温控降频计数和基准线程的上下文切换次数。条件不佳时给出警告，
+// 严格模式下拒绝运行（或判为失败）。/sys 中不存在的项留空，不视为异常。
+class ZBenchProbe {
+public:
+  /**
+   * @description: 严格模式，环境不佳时基准测试失败而不是只给出警告
+   */
+  static bool &strict() {
+    static bool enabled = false;
+    return enabled;
+  }
+  /**
+   * @description: 在基准线程上、计时开始前调用
+   * @param name 基准测试名，用于日志
+   * @throws runtime_error 严格模式下环境不佳时
+   */
+  void begin(const std::string &name) {
+    _name = name;
+    _env = ZBenchEnvironment();
+    const int cpu = sched_getcpu();
+    _env.cpu = cpu;
+    if (cpu >= 0) {
+      const std::string base =
+          "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+      _env.governor = readLine(base + "/cpufreq/scaling_governor");
+      _env.smt_siblings = readLine(base + "/topology/thread_siblings_list");
+      _throttle_before = throttleCount(base);
+    }
+    _env.turbo = turboState();
+    double load[1] = {0};
+    if (getloadavg(load, 1) == 1)
+      _env.load_before = load[0];
+    readSwitches(_switches_before);
+
+    if (!_env.governor.empty() && _env.governor != "performance")
+      _env.warnings.push_back("CPU governor is '" + _env.governor +
+                              "', not 'performance'");
+    if (_env.turbo == "on")
+      _env.warnings.push_back("Turbo boost is enabled");
+    if (_env.smt_siblings.find_first_of(",-") != std::string::npos)
+      _env.warnings.push_back("CPU " + std::to_string(cpu) +
+                              " shares its core with SMT siblings " +
+                              _env.smt_siblings);
+    // 负载均值是全系统的，要和在线 CPU 总数比较；此时线程已被绑定到
+    // 基准核心，亲和性掩码里只剩一个 CPU
+    const size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    if (_env.load_before > 0.5 * cpus)
+      _env.warnings.push_back("Load average " + format(_env.load_before) +
+                              " on " + std::to_string(cpus) + " CPUs");
+    report("pre-flight", 0);
+  }
+  /**
+   * @description: 在基准线程上、计时结束后调用
+   * @param elapsed_ms 基准测试耗时，用于判断上下文切换是否频繁
+   * @return 探测到的环境
+   * @throws runtime_error 严格模式下运行期间环境变差时
+   */
+  ZBenchEnvironment end(double elapsed_ms) {
+    const size_t pre_flight = _env.warnings.size();
+    long after[2] = {0, 0};
+    readSwitches(after);
+    _env.voluntary_switches += after[0] - _switches_before[0];
+    _env.involuntary_switches += after[1] - _switches_before[1];
+    double load[1] = {0};
+    if (getloadavg(load, 1) == 1)
+      _env.load_after = load[0];
+    if (_env.cpu >= 0) {
+      const uint64_t throttle = throttleCount(
+          "/sys/devices/system/cpu/cpu" + std::to_string(_env.cpu));
+      _env.throttle_events =
+          throttle > _throttle_before ? throttle - _throttle_before : 0;
+    }
+
+    if (_env.throttle_events > 0)
+      _env.warnings.push_back(std::to_string(_env.throttle_events) +
+                              " thermal throttling events during the run");
+    // 每100ms超过一次被抢占说明有其它任务在争用这个 CPU
+    if (_env.involuntary_switches > 10 &&
+        _env.involuntary_switches > elapsed_ms / 100)
+      _env.warnings.push_back(std::to_string(_env.involuntary_switches) +
+                              " involuntary context switches in " +
+                              format(elapsed_ms) + "ms");
+    report("in-flight", pre_flight);
+    return _env;
+  }
+
+  /**
+   * @description: 计入基准体所在的其它线程的上下文切换，可在多个线程上并发调用
+   * @param voluntary 主动切换次数
+   * @param involuntary 被抢占次数
+   */
+  void addSwitches(long voluntary, long involuntary) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _env.voluntary_switches += voluntary;
+    _env.involuntary_switches += involuntary;
+  }
+  /**
+   * @description: 读取当前线程累计的上下文切换次数
+   * @param out 主动切换和被抢占次数
+   */
+  static void readSwitches(long (&out)[2]) {
+    rusage usage{};
+    if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+      out[0] = usage.ru_nvcsw;
+      out[1] = usage.ru_nivcsw;
+    }
+  }
+
+private:
+  // 报告从 first 开始的新警告
+  void report(const char *phase, size_t first) {
+    if (_env.warnings.size() <= first)
+      return;
+    std::string reasons;
+    for (size_t i = first; i < _env.warnings.size(); ++i)
+      reasons += (reasons.empty() ? "" : "; ") + _env.warnings[i];
+    if (strict())
+      throw std::runtime_error(std::string("Benchmark environment rejected (") +
+                               phase + "): " + reasons);
+    logger.warning("[Benchmark] " + _name + " noisy environment (" + phase +
+                   "): " + reasons);
+  }
+
+  static std::string readLine(const std::string &path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+  }
+  // intel_pstate 的 no_turbo 与 acpi-cpufreq 的 boost 含义相反
+  static std::string turboState() {
+    const std::string no_turbo =
+        readLine("/sys/devices/system/cpu/intel_pstate/no_turbo");
+    if (!no_turbo.empty())
+      return no_turbo == "0" ? "on" : "off";
+    const std::string boost = readLine("/sys/devices/system/cpu/cpufreq/boost");
+    if (!boost.empty())
+      return boost == "1" ? "on" : "off";
+    return "";
+  }
+  static uint64_t throttleCount(const std::string &cpu_dir) {
+    uint64_t total = 0;
+    for (const char *counter : {"/thermal_throttle/core_throttle_count",
+                                "/thermal_throttle/package_throttle_count"}) {
+      const std::string value = readLine(cpu_dir + counter);
+      if (!value.empty())
+        total += std::stoull(value);
+    }
+    return total;
+  }
+  static std::string format(double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.2f", value);
+    return buf;
+  }
+
+  std::string _name;
+  ZBenchEnvironment _env;
+  uint64_t _throttle_before = 0;
+  long _switches_before[2] = {0, 0};
+  std::mutex _mutex;
+};
@@ -1,18 +1,50 @@
 
 #pragma once
+#include "ztest_affinity.hpp"
 #include "ztest_base.hpp"
+#include "ztest_benchenv.hpp"
+#include "ztest_coldstart.hpp"
+#include "ztest_registry.hpp"
 #include "ztest_result.hpp"
+#include "ztest_soak.hpp"
+#include "ztest_thread.hpp"
 #include "ztest_timer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <exception>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 // ZBenchMark类是用于执行基准测试的核心类，继承自 ZTestBase
 class ZBenchMark : public ZTestBase {
-private:
+protected:
   // std::function<void()> _benchmark_func;
   int _iterations = 1000; // 默认迭代次数
   std::vector<double> _iterationTimestamps;
+  ZBenchEnvironment _environment;
+  std::vector<ZScalingPoint> _scaling;
+  // 不计时的准备和清理：每次迭代前后，以及每 _batch_size 次迭代前后
+  std::function<void()> _setup;
+  std::function<void()> _teardown;
+  std::function<void()> _batch_setup;
+  std::function<void()> _batch_teardown;
+  int _batch_size = 1;
+  double _bytes_per_iteration = 0; // 声明的每次迭代处理量
+  double _items_per_iteration = 0;
+  std::vector<ZCounter> _counters;
+  double _duration_s = 0;   // 大于0时按时长运行（浸泡测试），不保存逐次耗时
+  double _measured_ms = 0;  // 计时部分的总耗时
+  uint64_t _completed = 0;  // 实际完成的迭代次数
+  std::optional<ZSoakSummary> _soak;
+  std::optional<ZLoadSummary> _load;
+  size_t _cold_samples = 0; // 大于0时在新进程中测量首次调用，不运行热迭代
+  std::optional<ZColdStartSummary> _cold_start;
 
 public:
   ZBenchMark(const std::string &name, const std::string &description = "")
@@ -21,6 +53,142 @@ public:
     _iterations = iterations;
     return *this;
   }
+  /**
+   * @description: 按时长运行（浸泡测试）而不是固定的迭代次数；延迟记入固定大小的
+   *               直方图和时间窗口序列，并检验 RSS 和延迟是否持续增长
+   * @param seconds 运行时长，0 表示按迭代次数运行
+   */
+  ZBenchMark &withDuration(double seconds) {
+    _duration_s = seconds;
+    return *this;
+  }
+  /**
+   * @description: 所有未单独设置时长的基准测试的浸泡时长（--soak）
+   */
+  static double &soakSeconds() {
+    static double seconds = 0;
+    return seconds;
+  }
+  /**
+   * @description: 冷启动模式：每个样本在新启动的进程中只运行一次基准体，
+   *               测量首次调用耗时、缺页次数和进程启动时间
+   * @param samples 样本数（子进程数），0 表示运行热迭代
+   */
+  ZBenchMark &withColdStart(size_t samples) {
+    _cold_samples = samples;
+    return *this;
+  }
+  /**
+   * @description: 每次迭代前调用，不计入迭代时间
+   */
+  ZBenchMark &withSetUp(std::function<void()> hook) {
+    _setup = std::move(hook);
+    return *this;
+  }
+  /**
+   * @description: 每次迭代后调用，不计入迭代时间
+   */
+  ZBenchMark &withTearDown(std::function<void()> hook) {
+    _teardown = std::move(hook);
+    return *this;
+  }
+  /**
+   * @description: 每批迭代前调用，不计入迭代时间
+   * @param hook 准备函数
+   * @param batch_size 每批的迭代次数
+   */
+  ZBenchMark &withBatchSetUp(std::function<void()> hook, int batch_size) {
+    _batch_setup = std::move(hook);
+    _batch_size = std::max(batch_size, 1);
+    return *this;
+  }
+  /**
+   * @description: 每批迭代后调用，不计入迭代时间
+   */
+  ZBenchMark &withBatchTearDown(std::function<void()> hook) {
+    _batch_teardown = std::move(hook);
+    return *this;
+  }
+
+  /**
+   * @description: 声明每次迭代处理的字节数，结果中汇总为字节每秒
+   */
+  ZBenchMark &withBytesPerIteration(double bytes) {
+    _bytes_per_iteration = bytes;
+    return *this;
+  }
+  /**
+   * @description: 声明每次迭代处理的条目数，结果中汇总为条目每秒
+   */
+  ZBenchMark &withItemsPerIteration(double items) {
+    _items_per_iteration = items;
+    return *this;
+  }
+  /**
+   * @description: 在基准体中累加本次迭代处理的字节数（处理量不固定时使用）
+   */
+  static void addBytes(double bytes) { counterTotals().bytes += bytes; }
+  /**
+   * @description: 在基准体中累加本次迭代处理的条目数
+   */
+  static void addItems(double items) { counterTotals().items += items; }
+  /**
+   * @description: 在基准体中累加自定义计数器。名称只在首次出现时复制，
+   *               之后在少量计数器中线性比较，计时部分内不分配内存
+   * @param name 计数器名
+   * @param value 本次迭代的增量
+   * @param kind 汇总为每秒速率或每次迭代的平均值
+   */
+  static void addCounter(std::string_view name, double value,
+                         ZCounterKind kind = ZCounterKind::z_average) {
+    auto &named = counterTotals().named;
+    auto it =
+        std::find_if(named.begin(), named.end(),
+                     [&](const NamedCounter &c) { return c.name == name; });
+    if (it == named.end())
+      it = named.insert(named.end(), {std::string(name), 0.0, kind});
+    it->total += value;
+    it->kind = kind;
+  }
+
+  /**
+   * @description: 暂停当前迭代的计时，基准体中的准备工作可放在
+   *               pauseTiming()/resumeTiming() 之间
+   */
+  static void pauseTiming() {
+    IterationClock &clock = iterationClock();
+    if (!clock.paused) {
+      clock.paused = true;
+      clock.paused_at = std::chrono::steady_clock::now();
+    }
+  }
+  /**
+   * @description: 恢复当前迭代的计时
+   */
+  static void resumeTiming() {
+    IterationClock &clock = iterationClock();
+    if (clock.paused) {
+      clock.paused = false;
+      clock.excluded += std::chrono::steady_clock::now() - clock.paused_at;
+    }
+  }
+  /**
+   * @description: 使编译器认为 value 被读取（和修改），计算它的代码不会被优化掉
+   */
+  template <typename T> static inline void doNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+  template <typename T> static inline void doNotOptimize(T &value) {
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#else
+    asm volatile("" : "+m,r"(value) : : "memory");
+#endif
+  }
+  /**
+   * @description: 使编译器认为所有内存都可能被读写，之前的写入必须真正完成
+   */
+  static inline void clobberMemory() { asm volatile("" : : : "memory"); }
 
   // ZBenchMark &setBenchmarkFunc(std::function<void()> func) {
   //   _benchmark_func = func;
@@ -40,31 +208,405 @@ public:
    * @description: 获取迭代时间戳
    * @return 每次迭代的耗时列表
    */
-  vector<double> getIterationTimestamps() const { return _iterationTimestamps; }
+  const vector<double> &getIterationTimestamps() const {
+    return _iterationTimestamps;
+  }
+  /**
+   * @description: 获取最近一次运行时探测到的环境
+   */
+  const ZBenchEnvironment &getEnvironment() const { return _environment; }
+  /**
+   * @description: 获取按线程数的扩展曲线，单线程基准测试为空
+   */
+  const std::vector<ZScalingPoint> &getScaling() const { return _scaling; }
+  /**
+   * @description: 获取最近一次运行汇总后的吞吐量和计数器
+   */
+  const std::vector<ZCounter> &getCounters() const { return _counters; }
+  /**
+   * @description: 所有迭代计时部分的总耗时（毫秒），不含准备、清理和暂停的时间
+   */
+  double getMeasuredTime() const { return _measured_ms; }
+  /**
+   * @description: 最近一次运行实际完成的迭代次数
+   */
+  uint64_t getCompletedIterations() const { return _completed; }
+  /**
+   * @description: 最近一次浸泡测试的汇总，按迭代次数运行时为空
+   */
+  const std::optional<ZSoakSummary> &getSoak() const { return _soak; }
+  /**
+   * @description: 负载测试的速率扫描结果，其它基准测试为空
+   */
+  const std::optional<ZLoadSummary> &getLoad() const { return _load; }
+  /**
+   * @description: 最近一次冷启动测量的样本和分布，运行热迭代时为空
+   */
+  const std::optional<ZColdStartSummary> &getColdStart() const {
+    return _cold_start;
+  }
+
+  /**
+   * @description: 冷启动子进程的入口：运行一次指定的基准体并把结果交给父进程
+   * @param name 基准测试全名
+   * @return 进程退出码
+   */
+  static int runColdStartChild(const std::string &name) {
+    for (const auto &test : ZTestRegistry::instance().takeTests()) {
+      auto *benchmark = dynamic_cast<ZBenchMark *>(test.get());
+      if (!benchmark || test->getName() != name)
+        continue;
+      return ZColdStart::runChild([benchmark] {
+        const double seconds = benchmark->runIteration(0, false);
+        // 批大小为1时 runIteration 已执行过批清理
+        if (benchmark->_batch_teardown && benchmark->_batch_size > 1)
+          benchmark->_batch_teardown();
+        return seconds;
+      });
+    }
+    std::cerr << "Benchmark not found: " << name << "\n";
+    return 2;
+  }
 
   virtual ZState run_single_case() {}
 
   /**
-   * @description: 执行基准测试的核心逻辑
+   * @description: 执行基准测试的核心逻辑；设置了保留核心时绑定到该核心运行，
+   *               前后探测运行环境
    */
   ZState run() override {
     // if (!_benchmark_func)
     // return ZState::z_failed;
 
+    const auto &affinity = ZAffinity::options();
+    ZPinnedScope pinned(affinity.benchmark_core, affinity.raise_priority);
+    ZBenchProbe probe;
+    probe.begin(getName());
     ZTimer timer;
     timer.start();
 
+    _iterationTimestamps.clear();
+    _soak.reset();
+    _cold_start.reset();
+    counterTotals() = CounterTotals();
+    const double soak_s = _duration_s > 0 ? _duration_s : soakSeconds();
+    const size_t cold_samples =
+        _cold_samples > 0 ? _cold_samples : ZColdStart::options().samples;
+    if (cold_samples > 0) {
+      runColdStart(cold_samples);
+    } else if (soak_s > 0) {
+      runSoak(soak_s);
+    } else {
+      _iterationTimestamps.reserve(std::max(_iterations, 0));
+      _measured_ms = 0;
+      for (int i = 0; i < _iterations; ++i) {
+        // _benchmark_func();
+        _iterationTimestamps.push_back(runIteration(i));
+        _measured_ms += _iterationTimestamps.back() * 1000.0;
+      }
+      _completed = _iterationTimestamps.size();
+    }
+    timer.stop();
+    collectCounters(counterTotals(), _completed);
+    _environment = probe.end(timer.getElapsedMilliseconds());
+
+    setState(ZState::z_success);
+    return ZState::z_success;
+  }
+
+protected:
+  struct NamedCounter {
+    std::string name;
+    double total;
+    ZCounterKind kind;
+  };
+  // 当前线程上累加的处理量和计数器，自定义计数器按首次出现的顺序排列
+  struct CounterTotals {
+    double bytes = 0;
+    double items = 0;
+    std::vector<NamedCounter> named;
+  };
+  static CounterTotals &counterTotals() {
+    thread_local CounterTotals totals;
+    return totals;
+  }
+  /**
+   * @description: 按计时部分的总耗时和迭代次数汇总计数器
+   * @param totals 运行期间累加的处理量和计数器
+   * @param iterations 累加期间的迭代次数
+   */
+  void collectCounters(const CounterTotals &totals, uint64_t iterations) {
+    _counters.clear();
+    const double seconds = getMeasuredTime() / 1000.0;
+    const auto reduce = [&](double total, ZCounterKind kind) {
+      if (kind == ZCounterKind::z_rate)
+        return seconds > 0 ? total / seconds : 0.0;
+      return iterations > 0 ? total / static_cast<double>(iterations) : 0.0;
+    };
+    const double bytes = totals.bytes + _bytes_per_iteration * iterations;
+    const double items = totals.items + _items_per_iteration * iterations;
+    if (bytes > 0)
+      _counters.push_back({"bytes", reduce(bytes, ZCounterKind::z_rate),
+                           ZCounterKind::z_rate});
+    if (items > 0)
+      _counters.push_back({"items", reduce(items, ZCounterKind::z_rate),
+                           ZCounterKind::z_rate});
+    for (const auto &counter : totals.named)
+      _counters.push_back({counter.name, reduce(counter.total, counter.kind),
+                           counter.kind});
+  }
+  /**
+   * @description: 浸泡测试：运行到时长用完，只保留直方图和窗口序列
+   * @param seconds 运行时长
+   */
+  void runSoak(double seconds) {
+    using clock = std::chrono::steady_clock;
+    ZSoakRecorder recorder(seconds);
+    const auto deadline =
+        clock::now() + std::chrono::duration_cast<clock::duration>(
+                           std::chrono::duration<double>(seconds));
+    int i = 0;
+    for (auto now = clock::now(); now < deadline; now = clock::now()) {
+      // 批次按迭代序号划分，序号回绕前对齐到批次边界
+      if (i == std::numeric_limits<int>::max() - _batch_size)
+        i = 0;
+      const double elapsed = runIteration(i++, false);
+      recorder.record(static_cast<uint64_t>(elapsed * 1e9), clock::now());
+    }
+    if (_batch_teardown && i % _batch_size != 0)
+      _batch_teardown();
+    _soak = recorder.finish();
+    _completed = _soak->iterations;
+    _measured_ms = recorder.histogram().sum() / 1e6;
+    for (const auto &warning : _soak->warnings)
+      logger.warning("[Soak] " + getName() + ": " + warning);
+  }
+  /**
+   * @description: 冷启动测试：迭代时间戳为各样本的首次调用耗时
+   * @param samples 子进程数
+   * @throws runtime_error 没有子进程返回结果时
+   */
+  void runColdStart(size_t samples) {
+    ZColdStartSummary summary = ZColdStart::measure(getName(), samples);
+    if (summary.samples.empty())
+      throw std::runtime_error("Cold start: none of " + std::to_string(samples) +
+                               " child processes of " + getName() +
+                               " returned a result");
+    _measured_ms = 0;
+    for (const auto &sample : summary.samples) {
+      _iterationTimestamps.push_back(sample.first_call_ns / 1e9);
+      _measured_ms += sample.first_call_ns / 1e6;
+    }
+    _completed = summary.samples.size();
+    const auto p50 = [&](const std::string &metric) {
+      for (const auto &m : summary.metrics)
+        if (m.name == metric)
+          return static_cast<double>(m.p50);
+      return 0.0;
+    };
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  ": %zu processes, %zu in parallel; p50 startup %.2fms, "
+                  "first call %.1fus, %.0f page faults",
+                  summary.samples.size(), summary.parallel,
+                  p50("startup_ns") / 1e6, p50("first_call_ns") / 1e3,
+                  p50("first_call_minor_faults"));
+    logger.info("[ColdStart] " + getName() + line);
+    _cold_start = std::move(summary);
+  }
+  /**
+   * @description: 运行第 i 次迭代及其准备和清理
+   * @param last_batch_known 迭代总数已知，最后一个不满的批次结束时也做批次清理
+   * @return 迭代计时部分的耗时（秒）
+   */
+  double runIteration(int i, bool last_batch_known = true) {
+    using clock = std::chrono::steady_clock;
+    if (_batch_setup && i % _batch_size == 0)
+      _batch_setup();
+    if (_setup)
+      _setup();
+    IterationClock &state = iterationClock();
+    state = IterationClock();
+    const auto start = clock::now();
+    run_single_case();
+    const auto end = clock::now();
+    if (state.paused) // 基准体暂停后没有恢复
+      state.excluded += end - state.paused_at;
+    state.paused = false;
+    if (_teardown)
+      _teardown();
+    if (_batch_teardown && ((i + 1) % _batch_size == 0 ||
+                            (last_batch_known && i + 1 == _iterations)))
+      _batch_teardown();
+    return std::max(
+        0.0, duration_cast<duration<double>>(end - start - state.excluded)
+                 .count());
+  }
+  /**
+   * @description: 连续运行 _iterations 次迭代，只计总耗时。没有准备和清理函数时
+   *               整段只读两次时钟，否则逐次调用 runIteration 把它们排除在外
+   * @return 所有迭代计时部分的总耗时（秒）
+   */
+  double runLoop() {
+    using clock = std::chrono::steady_clock;
+    if (_setup || _teardown || _batch_setup || _batch_teardown) {
+      double seconds = 0;
+      for (int i = 0; i < _iterations; ++i)
+        seconds += runIteration(i);
+      return seconds;
+    }
+    IterationClock &state = iterationClock();
+    state = IterationClock();
+    const auto start = clock::now();
     for (int i = 0; i < _iterations; ++i) {
-      auto start = std::chrono::steady_clock::now();
-      // _benchmark_func();
       run_single_case();
-      auto end = std::chrono::steady_clock::now();
-      _iterationTimestamps.push_back(
-          duration_cast<duration<double>>(end - start).count());
+      if (state.paused) { // 与 runIteration 一致，暂停只持续到本次迭代结束
+        state.excluded += clock::now() - state.paused_at;
+        state.paused = false;
+      }
     }
+    const auto end = clock::now();
+    return std::max(
+        0.0, duration_cast<duration<double>>(end - start - state.excluded)
+                 .count());
+  }
+
+private:
+  struct IterationClock {
+    std::chrono::steady_clock::time_point paused_at;
+    std::chrono::steady_clock::duration excluded{0};
+    bool paused = false;
+  };
+  static IterationClock &iterationClock() {
+    thread_local IterationClock clock;
+    return clock;
+  }
+};
+
+// ZThreadedBenchMark 依次在 1..N 个线程上运行基准体，每轮的线程通过自旋屏障
+// 同时起跑，各自运行 _iterations 次。线程按共享线程池的亲和性设置绑定，
+// 结果为每个线程数下的吞吐量、各线程耗时以及加速比和效率。
+// 迭代时间戳和计数器取自单线程一轮之前额外的一遍逐次计时运行。
+// 基准体可用 threadIndex()/threadCount() 区分线程，
+// 准备和清理函数在各自的基准线程上调用。不支持按时长运行（浸泡测试）。
+class ZThreadedBenchMark : public ZBenchMark {
+private:
+  size_t _max_threads = 1;
+
+public:
+  ZThreadedBenchMark(const std::string &name, size_t max_threads,
+                     const std::string &description = "")
+      : ZBenchMark(name, description),
+        _max_threads(std::max<size_t>(1, max_threads)) {}
+
+  std::unique_ptr<ZTestBase> clone() const override {
+    return std::make_unique<ZThreadedBenchMark>(*this);
+  }
+
+  size_t getMaxThreads() const { return _max_threads; }
+  /**
+   * @description: 当前线程在本轮中的序号，从0开始
+   */
+  static size_t threadIndex() { return slot().index; }
+  /**
+   * @description: 本轮的线程数
+   */
+  static size_t threadCount() { return slot().count; }
+
+  /**
+   * @description: 依次以 1..N 个线程运行，环境探测计入所有基准线程的上下文切换
+   */
+  ZState run() override {
+    ZBenchProbe probe;
+    probe.begin(getName());
+    ZTimer timer;
+    timer.start();
+    _scaling.clear();
+    _iterationTimestamps.clear();
+    for (size_t threads = 1; threads <= _max_threads; ++threads)
+      _scaling.push_back(runRound(threads, probe));
     timer.stop();
+    _environment = probe.end(timer.getElapsedMilliseconds());
 
+    const double base = _scaling.front().throughput;
+    for (auto &point : _scaling) {
+      point.speedup = base > 0 ? point.throughput / base : 0.0;
+      point.efficiency = point.speedup / point.threads;
+    }
     setState(ZState::z_success);
     return ZState::z_success;
   }
+
+private:
+  struct Slot {
+    size_t index = 0;
+    size_t count = 1;
+  };
+  static Slot &slot() {
+    thread_local Slot current;
+    return current;
+  }
+
+  ZScalingPoint runRound(size_t threads, ZBenchProbe &probe) {
+    ZSpinBarrier barrier(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    CounterTotals totals;
+    // 吞吐量按每个线程对整个循环的一次计时计算，每次迭代不读时钟也不写样本。
+    // 单线程一轮另外先逐次计时运行一遍，提供迭代时间戳、计数器和测量时间；
+    // 这一遍带有逐次计时的开销，不计入加速比的基准
+    std::vector<double> samples;
+    std::vector<double> seconds(threads, 0.0);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        ZAffinity::applyWorker(t);
+        slot() = {t, threads};
+        if (threads == 1)
+          samples.reserve(std::max(_iterations, 0));
+        counterTotals() = CounterTotals();
+        long before[2] = {0, 0}, after[2] = {0, 0};
+        ZBenchProbe::readSwitches(before);
+        barrier.arriveAndWait();
+        try {
+          if (threads == 1) {
+            for (int i = 0; i < _iterations; ++i)
+              samples.push_back(runIteration(i));
+            totals = counterTotals();
+          }
+          seconds[t] = runLoop();
+        } catch (...) {
+          errors[t] = std::current_exception();
+        }
+        ZBenchProbe::readSwitches(after);
+        probe.addSwitches(after[0] - before[0], after[1] - before[1]);
+      });
+    }
+    for (auto &worker : workers)
+      worker.join();
+    for (auto &error : errors)
+      if (error)
+        std::rethrow_exception(error);
+
+    // 线程同时起跑，最慢线程的计时部分即本轮的墙钟时间（不含准备和清理）
+    ZScalingPoint point;
+    point.threads = threads;
+    for (double thread_seconds : seconds) {
+      point.thread_ms.push_back(thread_seconds * 1000.0);
+      point.wall_ms = std::max(point.wall_ms, thread_seconds * 1000.0);
+    }
+    if (threads == 1) {
+      _measured_ms = 0;
+      for (double sample : samples)
+        _measured_ms += sample * 1000.0;
+      _iterationTimestamps = std::move(samples);
+      _completed = _iterationTimestamps.size();
+      collectCounters(totals, _completed);
+    }
+    point.throughput = point.wall_ms > 0
+                           ? threads * static_cast<double>(_iterations) /
+                                 (point.wall_ms / 1000.0)
+                           : 0.0;
+    return point;
+  }
 };
@@ -0,0 +1,207 @@
+#pragma once
+#include "ztest_base.hpp"
+#include "ztest_dataregistry.hpp"
+#include "ztest_logger.hpp"
+#include "ztest_result.hpp"
+#include "ztest_utils.hpp"
+#include <atomic>
+#include <cstring>
+#include <elf.h>
+#include <fstream>
+#include <link.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+// ZResultCache 是可选的测试结果缓存。
+// 缓存键由测试名、测试二进制的构建ID以及测试声明的数据文件内容哈希组成，
+// 键未变化的测试会被跳过并复用上次的 ZTestResult。
+class ZResultCache {
+public:
+  static ZResultCache &instance() {
+    static ZResultCache cache;
+    return cache;
+  }
+  /**
+   * @description: 启用结果缓存并从磁盘加载已有条目
+   * @param path 缓存文件路径
+   */
+  void enable(const std::string &path = ".ztest_cache.json") {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _path = path;
+    _build_id = computeBuildId();
+    loadLocked();
+    // 最后才置位：不加锁读到 true 的线程也能看到上面写入的构建ID
+    _enabled = true;
+    logger.info("Result cache enabled: " + path + " (build " +
+                hashToHex(_build_id) + ", " + std::to_string(_entries.size()) +
+                " entries)");
+  }
+  /**
+   * @description: 停用结果缓存，已有条目先写回磁盘，再次启用时重新加载
+   */
+  void disable() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_enabled)
+      return;
+    saveLocked();
+    _enabled = false;
+    logger.info("Result cache disabled: " + _path);
+  }
+  bool isEnabled() const { return _enabled; }
+  /**
+   * @description: 计算测试的缓存键
+   * @param test 测试用例
+   * @return 缓存键
+   */
+  uint64_t makeKey(const ZTestBase &test) {
+    uint64_t key = fnv1a64(test.getName());
+    key = fnv1a64(&_build_id, sizeof(_build_id), key);
+    for (const auto &path : test.getDataFiles()) {
+      uint64_t content = ZDataRegistry::instance().fileHash(path);
+      key = fnv1a64(path, key);
+      key = fnv1a64(&content, sizeof(content), key);
+    }
+    return key;
+  }
+  /**
+   * @description: 查找可复用的缓存结果
+   * @param test 测试用例
+   * @param result 命中时写入缓存的结果
+   * @return 命中返回true
+   */
+  bool lookup(const ZTestBase &test, ZTestResult &result) {
+    if (!_enabled || !test.cacheable() || test.isMarkedUncacheable())
+      return false;
+    uint64_t key = makeKey(test);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(test.getName());
+    if (it == _entries.end() || it->second.key != key)
+      return false;
+    const auto &entry = it->second;
+    result.setResult(test.getName(), entry.type, ZState::z_success, "", {}, {},
+                     entry.duration, entry.iterations);
+    result.setCached(true);
+    return true;
+  }
+  /**
+   * @description: 记录测试结果，仅缓存可复用（cacheable）测试的通过结果
+   * @param test 测试用例
+   * @param result 测试结果
+   */
+  void store(const ZTestBase &test, const ZTestResult &result) {
+    if (!_enabled || result.isCached() || !test.cacheable())
+      return;
+    uint64_t key = makeKey(test);
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (result.getState() != ZState::z_success || test.isMarkedUncacheable()) {
+      _entries.erase(test.getName());
+      return;
+    }
+    _entries[test.getName()] = {key, result.getType(), result.getUsedTime(),
+                                result.getIterations()};
+  }
+  /**
+   * @description: 将缓存条目写回磁盘
+   */
+  void save() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_enabled)
+      saveLocked();
+  }
+
+private:
+  struct Entry {
+    uint64_t key;
+    ZType type;
+    double duration;
+    uint64_t iterations;
+  };
+
+  ZResultCache() = default;
+  /**
+   * @description: 将缓存条目写回磁盘，调用方持锁
+   */
+  void saveLocked() {
+    json root;
+    root["build_id"] = hashToHex(_build_id);
+    root["entries"] = json::object();
+    for (const auto &[name, entry] : _entries) {
+      root["entries"][name] = {{"key", hashToHex(entry.key)},
+                               {"type", static_cast<int>(entry.type)},
+                               {"duration", entry.duration},
+                               {"iterations", entry.iterations}};
+    }
+    std::ofstream file(_path, std::ios::trunc);
+    if (!file) {
+      logger.error("Failed to write result cache: " + _path);
+      return;
+    }
+    file << root.dump(2);
+  }
+  /**
+   * @description: 从磁盘读取缓存条目，文件损坏时丢弃全部条目
+   */
+  void loadLocked() {
+    _entries.clear();
+    std::ifstream file(_path);
+    if (!file)
+      return;
+    try {
+      json root = json::parse(file);
+      for (const auto &[name, value] : root.at("entries").items()) {
+        _entries[name] = {
+            std::stoull(value.at("key").get<std::string>(), nullptr, 16),
+            static_cast<ZType>(value.at("type").get<int>()),
+            value.at("duration").get<double>(),
+            value.at("iterations").get<uint64_t>()};
+      }
+    } catch (const std::exception &e) {
+      logger.warning("Discarding unreadable result cache " + _path + ": " +
+                     e.what());
+      _entries.clear();
+    }
+  }
+  /**
+   * @description: 读取主程序的GNU构建ID，缺失时退化为可执行文件内容哈希
+   * @return 构建ID哈希
+   */
+  static uint64_t computeBuildId() {
+    uint64_t build_id = 0;
+    dl_iterate_phdr(
+        [](struct dl_phdr_info *info, size_t, void *data) -> int {
+          auto *out = static_cast<uint64_t *>(data);
+          for (int i = 0; i < info->dlpi_phnum; ++i) {
+            const auto &phdr = info->dlpi_phdr[i];
+            if (phdr.p_type != PT_NOTE)
+              continue;
+            auto *note = reinterpret_cast<const char *>(info->dlpi_addr +
+                                                        phdr.p_vaddr);
+            size_t offset = 0;
+            while (offset + sizeof(ElfW(Nhdr)) <= phdr.p_memsz) {
+              auto *nhdr = reinterpret_cast<const ElfW(Nhdr) *>(note + offset);
+              size_t name_size = (nhdr->n_namesz + 3) & ~size_t(3);
+              size_t desc_size = (nhdr->n_descsz + 3) & ~size_t(3);
+              const char *desc = note + offset + sizeof(ElfW(Nhdr)) + name_size;
+              if (nhdr->n_type == NT_GNU_BUILD_ID && nhdr->n_namesz == 4 &&
+                  std::memcmp(note + offset + sizeof(ElfW(Nhdr)), "GNU", 4) ==
+                      0) {
+                *out = fnv1a64(desc, nhdr->n_descsz);
+                return 1;
+              }
+              offset += sizeof(ElfW(Nhdr)) + name_size + desc_size;
+            }
+          }
+          return 1; // 第一个对象即主程序
+        },
+        &build_id);
+    if (build_id == 0)
+      build_id = hashFileContent("/proc/self/exe");
+    return build_id;
+  }
+
+  std::mutex _mutex;
+  std::atomic<bool> _enabled{false}; // lookup/store 在加锁前读取
+  std::string _path;
+  uint64_t _build_id = 0;
+  std::unordered_map<std::string, Entry> _entries;
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include "ztest_utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+// 失败聚类：将错误信息规范化（屏蔽测试名、数字和地址）后按特征哈希分组，
+// 同一缺陷导致的大量相似失败在报告、AI提示和GUI中只出现一次并附带计数。
+struct ZFailureBucket {
+  uint64_t signature = 0;
+  std::string pattern;        // 规范化后的错误信息
+  std::string example;        // 第一条原始错误信息
+  std::set<std::string> tests; // 属于该分组的测试名（有序）
+
+  size_t count() const { return tests.size(); }
+};
+
+class ZFailureClusters {
+public:
+  /**
+   * @description: 规范化错误信息
+   *               测试名替换为<test>，0x开头的地址替换为0x?，数字替换为#
+   * @param test_name 测试名
+   * @param message 原始错误信息
+   * @return 规范化后的错误信息
+   */
+  static std::string normalize(std::string_view test_name,
+                               std::string_view message) {
+    std::string out;
+    out.reserve(message.size());
+    size_t i = 0;
+    while (i < message.size()) {
+      if (!test_name.empty() && message.compare(i, test_name.size(),
+                                                test_name) == 0) {
+        out += "<test>";
+        i += test_name.size();
+        continue;
+      }
+      const char c = message[i];
+      if (c == '0' && i + 2 < message.size() &&
+          (message[i + 1] == 'x' || message[i + 1] == 'X') &&
+          std::isxdigit(static_cast<unsigned char>(message[i + 2]))) {
+        i += 2;
+        while (i < message.size() &&
+               std::isxdigit(static_cast<unsigned char>(message[i])))
+          ++i;
+        out += "0x?";
+        continue;
+      }
+      if (std::isdigit(static_cast<unsigned char>(c))) {
+        // 整数、小数和指数形式都视为一个数字
+        while (i < message.size() &&
+               (std::isdigit(static_cast<unsigned char>(message[i])) ||
+                message[i] == '.' ||
+                ((message[i] == 'e' || message[i] == 'E') &&
+                 i + 1 < message.size() &&
+                 (std::isdigit(static_cast<unsigned char>(message[i + 1])) ||
+                  message[i + 1] == '-' || message[i + 1] == '+')))) {
+          if (message[i] == 'e' || message[i] == 'E')
+            ++i; // 跳过指数符号
+          ++i;
+        }
+        out += '#';
+        continue;
+      }
+      out += c;
+      ++i;
+    }
+    return out;
+  }
+  /**
+   * @description: 计算失败的特征哈希
+   */
+  static uint64_t signature(std::string_view test_name,
+                            std::string_view message) {
+    return fnv1a64(normalize(test_name, message));
+  }
+
+  void add(const std::string &test_name, const std::string &message) {
+    std::string pattern = normalize(test_name, message);
+    uint64_t key = fnv1a64(pattern);
+    auto &bucket = _buckets[key];
+    if (bucket.tests.empty()) {
+      bucket.signature = key;
+      bucket.pattern = std::move(pattern);
+      bucket.example = message;
+    }
+    bucket.tests.insert(test_name);
+  }
+
+  void remove(const std::string &test_name, const std::string &message) {
+    auto it = _buckets.find(signature(test_name, message));
+    if (it == _buckets.end())
+      return;
+    it->second.tests.erase(test_name);
+    if (it->second.tests.empty())
+      _buckets.erase(it);
+  }
+  /**
+   * @description: 获取所有分组，按失败数量降序
+   */
+  std::vector<ZFailureBucket> buckets() const {
+    std::vector<ZFailureBucket> out;
+    out.reserve(_buckets.size());
+    for (const auto &[key, bucket] : _buckets)
+      out.push_back(bucket);
+    std::sort(out.begin(), out.end(), [](const auto &a, const auto &b) {
+      return a.count() != b.count() ? a.count() > b.count()
+                                    : a.signature < b.signature;
+    });
+    return out;
+  }
+  size_t size() const { return _buckets.size(); }
+
+private:
+  std::unordered_map<uint64_t, ZFailureBucket> _buckets;
+};
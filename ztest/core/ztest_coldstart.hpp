@@ -0,0 +1,245 @@
+#pragma once
+#include "ztest_affinity.hpp"
+#include "ztest_histogram.hpp"
+#include "ztest_logger.hpp"
+#include "ztest_result.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
+#include <fstream>
+#include <mutex>
+#include <sched.h>
+#include <set>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+// 冷启动基准测试：每个样本 fork/exec 一个新的测试进程，只运行一次选定的基准体，
+// 测量首次调用的耗时、缺页次数以及进程启动（动态链接、静态初始化、测试注册）的耗时。
+// 这些开销在同一进程的热迭代中只出现一次，会被平均掉。
+// 子进程的命令行为 `<exe> --no-gui --cold-start-child <测试名>`，结果写到文件描述符3，
+// 入口需要把 --no-gui 交给 runFromCLI。多个样本同时运行，各绑定到一个物理核心。
+struct ZColdStartOptions {
+  size_t samples = 0;  // 所有基准测试的冷启动样本数，0 表示只运行热迭代
+  size_t parallel = 0; // 同时运行的子进程数，0 表示每个可用物理核心一个
+};
+
+class ZColdStart {
+public:
+  static constexpr const char *kChildFlag = "--cold-start-child";
+  static constexpr int kResultFd = 3;
+
+  static ZColdStartOptions &options() {
+    static ZColdStartOptions opts;
+    return opts;
+  }
+
+  /**
+   * @description: 在新进程中运行 samples 次基准体
+   * @param name 基准测试全名
+   * @param samples 样本数
+   * @return 样本和各项分布；失败的子进程计入 failed
+   */
+  static ZColdStartSummary measure(const std::string &name, size_t samples) {
+    ZColdStartSummary summary;
+    std::vector<int> cpus = coreCpus();
+    const size_t limit = options().parallel > 0 ? options().parallel
+                                                : std::max<size_t>(cpus.size(), 1);
+    summary.parallel = std::max<size_t>(1, std::min(limit, samples));
+
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    std::vector<std::thread> launchers;
+    for (size_t slot = 0; slot < summary.parallel; ++slot) {
+      const int cpu = cpus.empty() ? -1 : cpus[slot % cpus.size()];
+      launchers.emplace_back([&, cpu] {
+        while (next++ < samples) {
+          ZColdSample sample;
+          const bool ok = spawn(name, cpu, sample);
+          std::lock_guard<std::mutex> lock(mutex);
+          if (ok)
+            summary.samples.push_back(sample);
+          else
+            summary.failed++;
+        }
+      });
+    }
+    for (auto &launcher : launchers)
+      launcher.join();
+
+    const auto metric = [&](const char *metric_name, auto field) {
+      ZHdrHistogram histogram;
+      for (const auto &sample : summary.samples)
+        histogram.record(static_cast<uint64_t>(std::max<double>(sample.*field, 0)));
+      summary.metrics.push_back({metric_name, histogram.mean(), histogram.min(),
+                                 histogram.percentile(50),
+                                 histogram.percentile(90),
+                                 histogram.percentile(99), histogram.max()});
+    };
+    metric("startup_ns", &ZColdSample::startup_ns);
+    metric("first_call_ns", &ZColdSample::first_call_ns);
+    metric("process_ns", &ZColdSample::process_ns);
+    metric("startup_minor_faults", &ZColdSample::startup_minor_faults);
+    metric("startup_major_faults", &ZColdSample::startup_major_faults);
+    metric("first_call_minor_faults", &ZColdSample::first_call_minor_faults);
+    metric("first_call_major_faults", &ZColdSample::first_call_major_faults);
+    return summary;
+  }
+
+  /**
+   * @description: 子进程入口：记录启动结束时的时刻和缺页次数，运行一次基准体，
+   *               把结果写到 kResultFd
+   * @param first_call 运行一次基准体，返回计时部分的耗时（秒）
+   * @return 进程退出码
+   */
+  static int runChild(const std::function<double()> &first_call) {
+    const auto ready = std::chrono::steady_clock::now();
+    rusage before{}, after{};
+    getrusage(RUSAGE_SELF, &before);
+    const double seconds = first_call();
+    getrusage(RUSAGE_SELF, &after);
+
+    // steady_clock 在 Linux 上是系统范围的 CLOCK_MONOTONIC，父子进程可以直接比较
+    const std::string line =
+        std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           ready.time_since_epoch())
+                           .count()) +
+        " " + std::to_string(seconds * 1e9) + " " +
+        std::to_string(before.ru_minflt) + " " +
+        std::to_string(before.ru_majflt) + " " +
+        std::to_string(after.ru_minflt - before.ru_minflt) + " " +
+        std::to_string(after.ru_majflt - before.ru_majflt) + "\n";
+    size_t written = 0;
+    while (written < line.size()) {
+      const ssize_t n =
+          write(kResultFd, line.data() + written, line.size() - written);
+      if (n <= 0)
+        return 1;
+      written += static_cast<size_t>(n);
+    }
+    return 0;
+  }
+
+private:
+  /**
+   * @description: 运行一个子进程并读取它的结果
+   * @param cpu 子进程绑定的 CPU，-1 表示不绑定
+   * @return 子进程正常退出并返回了结果时为 true
+   */
+  static bool spawn(const std::string &name, int cpu, ZColdSample &sample) {
+    // fork 之后到 exec 之前只能做异步信号安全的调用，参数提前准备好
+    std::string exe = "/proc/self/exe", no_gui = "--no-gui",
+                flag = kChildFlag, test = name;
+    char *argv[] = {exe.data(), no_gui.data(), flag.data(), test.data(),
+                    nullptr};
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpu >= 0)
+      CPU_SET(cpu, &set);
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+      logger.warning("[ColdStart] pipe failed for " + name);
+      return false;
+    }
+
+    sample.cpu = cpu;
+    const auto start = std::chrono::steady_clock::now();
+    const pid_t pid = fork();
+    if (pid == 0) {
+      if (fds[1] == kResultFd)
+        fcntl(kResultFd, F_SETFD, 0);
+      else
+        dup2(fds[1], kResultFd); // 复制出的描述符不带 O_CLOEXEC
+      if (cpu >= 0)
+        sched_setaffinity(0, sizeof(set), &set);
+      execv(argv[0], argv);
+      _exit(127);
+    }
+    close(fds[1]);
+    if (pid < 0) {
+      close(fds[0]);
+      logger.warning("[ColdStart] fork failed for " + name);
+      return false;
+    }
+
+    std::string output;
+    char buf[256];
+    for (ssize_t n; (n = read(fds[0], buf, sizeof(buf))) != 0;) {
+      if (n > 0)
+        output.append(buf, static_cast<size_t>(n));
+      else if (errno != EINTR)
+        break;
+    }
+    close(fds[0]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    sample.process_ns = std::chrono::duration<double, std::nano>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+
+    long long ready_ns = 0;
+    std::istringstream in(output);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+        !(in >> ready_ns >> sample.first_call_ns >>
+          sample.startup_minor_faults >> sample.startup_major_faults >>
+          sample.first_call_minor_faults >> sample.first_call_major_faults)) {
+      logger.warning("[ColdStart] " + name + ": child " + std::to_string(pid) +
+                     (WIFSIGNALED(status)
+                          ? " killed by signal " +
+                                std::to_string(WTERMSIG(status))
+                          : " exited with status " +
+                                std::to_string(WEXITSTATUS(status))) +
+                     " without a result");
+      return false;
+    }
+    sample.startup_ns = static_cast<double>(
+        ready_ns - std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       start.time_since_epoch())
+                       .count());
+    return true;
+  }
+  /**
+   * @description: 可用于子进程的 CPU，每个物理核心只取一个（SMT 兄弟线程共享缓存，
+   *               会相互干扰），排除保留给基准测试的核心
+   */
+  static std::vector<int> coreCpus() {
+    std::vector<int> out;
+    std::set<int> taken;
+    for (int cpu : ZAffinity::workerCpus()) {
+      if (taken.count(cpu))
+        continue;
+      out.push_back(cpu);
+      std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                       "/topology/thread_siblings_list");
+      std::string list;
+      std::getline(in, list);
+      for (const int sibling : parseCpuList(list))
+        taken.insert(sibling);
+    }
+    return out;
+  }
+  // 解析 "0,4" 或 "0-1" 形式的 CPU 列表
+  static std::vector<int> parseCpuList(const std::string &list) {
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+      int first = 0, last = 0;
+      const int n = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+      if (n == 1)
+        last = first;
+      if (n >= 1)
+        for (int cpu = first; cpu <= last; ++cpu)
+          cpus.push_back(cpu);
+    }
+    return cpus;
+  }
+};
@@ -0,0 +1,315 @@
+#pragma once
+#include "ztest_parameterized.hpp"
+#include "ztest_utils.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+// 二进制列式数据集格式（.zcol），可直接 mmap 使用，无需解析。
+// 布局：文件头 | 列描述表 | 各列数据（8字节对齐）
+//   int 列   : rows 个 int64
+//   double 列: rows 个 float64
+//   string 列: rows+1 个 uint64 偏移 + 字符数据
+// 与 CSV 数据集一致，最后一列为期望输出，其余列为输入。
+enum class ZColumnType : uint8_t { z_int = 0, z_double = 1, z_string = 2 };
+
+struct ZColumnarHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t rows;
+  uint32_t columns;
+  uint32_t reserved;
+};
+
+struct ZColumnDesc {
+  ZColumnType type;
+  uint8_t padding[7];
+  uint64_t offset; // 列数据相对文件起始的偏移
+  uint64_t length; // 列数据的字节数
+};
+
+constexpr char kColumnarMagic[4] = {'Z', 'C', 'O', 'L'};
+constexpr uint32_t kColumnarVersion = 1;
+
+// 只读映射一个 .zcol 文件并提供按列的类型化访问。
+class ZColumnarDataManager : public ZDataManager {
+public:
+  ZColumnarDataManager(const std::string &filename) : _filename(filename) {
+    logger.debug("Mapping columnar dataset: " + filename);
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Failed to open columnar dataset: " + filename);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(ZColumnarHeader)) {
+      ::close(fd);
+      throw std::runtime_error("Invalid columnar dataset: " + filename);
+    }
+    _mapped_size = static_cast<size_t>(st.st_size);
+    void *addr = ::mmap(nullptr, _mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+      throw std::runtime_error("Failed to mmap columnar dataset: " + filename);
+    _base = static_cast<const char *>(addr);
+    ::madvise(addr, _mapped_size, MADV_WILLNEED);
+
+    try {
+      validate();
+    } catch (...) {
+      ::munmap(addr, _mapped_size);
+      throw;
+    }
+    logger.info("Mapped " + std::to_string(_header->rows) + " rows x " +
+                std::to_string(_header->columns) + " columns from " + filename);
+  }
+  ZColumnarDataManager(const ZColumnarDataManager &) = delete;
+  ZColumnarDataManager &operator=(const ZColumnarDataManager &) = delete;
+  ~ZColumnarDataManager() override {
+    if (_base)
+      ::munmap(const_cast<char *>(_base), _mapped_size);
+  }
+
+  const std::string &getName() const override { return _filename; }
+  size_t size() const override { return _header->rows; }
+  /**
+   * @description: 映射区域的大小即数据集占用
+   */
+  size_t memoryFootprint() const override {
+    return sizeof(*this) + _mapped_size;
+  }
+  size_t columns() const { return _header->columns; }
+  ZColumnType columnType(size_t column) const { return _desc[column].type; }
+  /**
+   * @description: 获取数值列的连续数据
+   * @tparam T int64_t 或 double，须与列类型一致
+   * @param column 列号
+   * @return 指向 rows 个元素的指针
+   */
+  template <typename T> const T *column(size_t column) const {
+    static_assert(std::is_same_v<T, int64_t> || std::is_same_v<T, double>,
+                  "numeric columns are int64_t or double");
+    constexpr ZColumnType expected = std::is_same_v<T, int64_t>
+                                         ? ZColumnType::z_int
+                                         : ZColumnType::z_double;
+    checkType(column, expected);
+    return reinterpret_cast<const T *>(_base + _desc[column].offset);
+  }
+  /**
+   * @description: 获取字符串列中的一个值，返回视图不拷贝
+   * @throws out_of_range 行号超出数据集时
+   */
+  std::string_view stringAt(size_t column, size_t row) const {
+    checkType(column, ZColumnType::z_string);
+    if (row >= rows())
+      throw std::out_of_range("Row " + std::to_string(row) + " of " +
+                              _filename + " is out of range");
+    const auto *offsets =
+        reinterpret_cast<const uint64_t *>(_base + _desc[column].offset);
+    const char *chars = reinterpret_cast<const char *>(offsets + rows() + 1);
+    return {chars + offsets[row], offsets[row + 1] - offsets[row]};
+  }
+  /**
+   * @description: 读取当前行某列的值
+   * @tparam T int64_t、double 或 std::string_view；int 列可按 double 读取
+   */
+  template <typename T> T get(size_t column) const {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      return stringAt(column, _index);
+    } else if constexpr (std::is_same_v<T, double>) {
+      if (_desc[column].type == ZColumnType::z_int)
+        return static_cast<double>(this->column<int64_t>(column)[_index]);
+      return this->column<double>(column)[_index];
+    } else {
+      return static_cast<T>(this->column<int64_t>(column)[_index]);
+    }
+  }
+  size_t rows() const { return _header->rows; }
+  size_t row() const { return _index; }
+  bool has_next() const { return _index < _header->rows; }
+  void next() { ++_index; }
+  void reset() { _index = 0; }
+
+private:
+  void checkType(size_t column, ZColumnType expected) const {
+    if (column >= _header->columns || _desc[column].type != expected)
+      throw std::runtime_error("Column " + std::to_string(column) + " of " +
+                               _filename + " has a different type");
+  }
+  void validate() {
+    _header = reinterpret_cast<const ZColumnarHeader *>(_base);
+    if (std::memcmp(_header->magic, kColumnarMagic, 4) != 0 ||
+        _header->version != kColumnarVersion)
+      throw std::runtime_error("Not a columnar dataset: " + _filename);
+    // 先按文件大小限制计数，后面的乘法和加法才不会溢出
+    if (_header->columns > (_mapped_size - sizeof(ZColumnarHeader)) /
+                               sizeof(ZColumnDesc) ||
+        _header->rows >= _mapped_size / sizeof(uint64_t))
+      throw std::runtime_error("Truncated columnar dataset: " + _filename);
+    _desc = reinterpret_cast<const ZColumnDesc *>(_base +
+                                                  sizeof(ZColumnarHeader));
+    for (size_t c = 0; c < _header->columns; ++c) {
+      const auto &desc = _desc[c];
+      if (desc.type > ZColumnType::z_string || desc.offset % 8 != 0 ||
+          desc.offset > _mapped_size ||
+          desc.length > _mapped_size - desc.offset)
+        throw std::runtime_error("Corrupt column table in " + _filename);
+      size_t minimum = desc.type == ZColumnType::z_string
+                           ? (_header->rows + 1) * sizeof(uint64_t)
+                           : _header->rows * 8;
+      if (desc.length < minimum)
+        throw std::runtime_error("Truncated column in " + _filename);
+      if (desc.type == ZColumnType::z_string)
+        validateOffsets(desc, desc.length - minimum);
+    }
+  }
+  /**
+   * @description: 字符串列的偏移必须单调不减，且最后一个偏移不超出字符数据，
+   *               stringAt 才能直接使用偏移而不越过映射区域
+   * @param chars 列中字符数据的字节数
+   */
+  void validateOffsets(const ZColumnDesc &desc, uint64_t chars) const {
+    const auto *offsets =
+        reinterpret_cast<const uint64_t *>(_base + desc.offset);
+    for (size_t r = 0; r < _header->rows; ++r)
+      if (offsets[r] > offsets[r + 1])
+        throw std::runtime_error("Corrupt string offsets in " + _filename);
+    if (offsets[_header->rows] > chars)
+      throw std::runtime_error("Corrupt string offsets in " + _filename);
+  }
+
+  std::string _filename;
+  const char *_base = nullptr;
+  size_t _mapped_size = 0;
+  const ZColumnarHeader *_header = nullptr;
+  const ZColumnDesc *_desc = nullptr;
+  size_t _index = 0;
+};
+
+// 将 CSV 数据集一次性转换为列式格式，列类型按整列推断：
+// 全部为整数时为 int，全部为数值时为 double，否则为 string。
+class ZColumnarConverter {
+public:
+  /**
+   * @description: 转换 CSV 文件
+   * @param csv_path CSV 文件路径
+   * @param out_path 输出的 .zcol 文件路径
+   * @return 写入的行数
+   */
+  static size_t fromCSV(const std::string &csv_path,
+                        const std::string &out_path) {
+    std::vector<std::vector<CSVCell>> rows;
+    CSVStream(csv_path) >> rows;
+    if (rows.empty())
+      throw std::runtime_error("CSV file is empty or missing: " + csv_path);
+    const size_t columns = rows.front().size();
+    for (size_t r = 0; r < rows.size(); ++r) {
+      if (rows[r].size() != columns)
+        throw std::runtime_error("Row " + std::to_string(r + 1) + " of " +
+                                 csv_path + " has " +
+                                 std::to_string(rows[r].size()) +
+                                 " columns, expected " +
+                                 std::to_string(columns));
+    }
+
+    std::vector<ZColumnDesc> descs(columns);
+    std::vector<std::string> blobs(columns);
+    uint64_t offset = align8(sizeof(ZColumnarHeader) +
+                             columns * sizeof(ZColumnDesc));
+    for (size_t c = 0; c < columns; ++c) {
+      descs[c] = {};
+      descs[c].type = inferType(rows, c);
+      blobs[c] = encodeColumn(rows, c, descs[c].type);
+      descs[c].offset = offset;
+      descs[c].length = blobs[c].size();
+      offset = align8(offset + blobs[c].size());
+    }
+
+    std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+      throw std::runtime_error("Failed to create columnar dataset: " +
+                               out_path);
+    ZColumnarHeader header{};
+    std::memcpy(header.magic, kColumnarMagic, 4);
+    header.version = kColumnarVersion;
+    header.rows = rows.size();
+    header.columns = static_cast<uint32_t>(columns);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(descs.data()),
+              columns * sizeof(ZColumnDesc));
+    for (size_t c = 0; c < columns; ++c) {
+      pad(out, descs[c].offset);
+      out.write(blobs[c].data(), blobs[c].size());
+    }
+    if (!out)
+      throw std::runtime_error("Failed to write columnar dataset: " +
+                               out_path);
+    logger.info("Converted " + csv_path + " -> " + out_path + " (" +
+                std::to_string(rows.size()) + " rows)");
+    return rows.size();
+  }
+
+private:
+  static uint64_t align8(uint64_t value) { return (value + 7) & ~uint64_t(7); }
+
+  static void pad(std::ofstream &out, uint64_t target) {
+    static const char zeros[8] = {};
+    auto position = static_cast<uint64_t>(out.tellp());
+    if (target > position)
+      out.write(zeros, target - position);
+  }
+
+  static ZColumnType inferType(const std::vector<std::vector<CSVCell>> &rows,
+                               size_t column) {
+    bool all_int = true;
+    for (const auto &row : rows) {
+      if (std::holds_alternative<std::string>(row[column]))
+        return ZColumnType::z_string;
+      all_int = all_int && std::holds_alternative<int>(row[column]);
+    }
+    return all_int ? ZColumnType::z_int : ZColumnType::z_double;
+  }
+
+  static std::string encodeColumn(const std::vector<std::vector<CSVCell>> &rows,
+                                  size_t column, ZColumnType type) {
+    std::string blob;
+    auto append = [&blob](const auto &value) {
+      blob.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+    if (type == ZColumnType::z_int) {
+      for (const auto &row : rows)
+        append(static_cast<int64_t>(std::get<int>(row[column])));
+    } else if (type == ZColumnType::z_double) {
+      for (const auto &row : rows)
+        append(std::visit(
+            [](const auto &value) -> double {
+              if constexpr (std::is_arithmetic_v<
+                                std::decay_t<decltype(value)>>)
+                return static_cast<double>(value);
+              else
+                return 0.0;
+            },
+            row[column]));
+    } else {
+      std::string chars;
+      uint64_t position = 0;
+      append(position);
+      for (const auto &row : rows) {
+        std::ostringstream oss;
+        std::visit([&oss](const auto &value) { oss << value; }, row[column]);
+        chars += oss.str();
+        position = chars.size();
+        append(position);
+      }
+      blob += chars;
+    }
+    return blob;
+  }
+};
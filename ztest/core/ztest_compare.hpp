@@ -0,0 +1,350 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+// 数组/缓冲区批量比较：按固定大小的块做无分支的不匹配计数（可被编译器向量化），
+// 只有存在不匹配的块才逐元素定位；字节比较使用 SSE2/AVX2 指令。
+// 比较结果只在失败时格式化，供 EXPECT_ARRAY_EQ/EXPECT_ARRAY_NEAR/EXPECT_BYTES_EQ 使用。
+
+// 近似比较的容差，满足任意一项即视为相等；直接传入数值时表示绝对容差
+struct ZTolerance {
+  double abs = 0.0;
+  double rel = 0.0;
+  uint64_t ulp = 0;
+
+  ZTolerance(double absolute = 0.0) : abs(absolute) {}
+  static ZTolerance absolute(double value) { return ZTolerance(value); }
+  static ZTolerance relative(double value) {
+    ZTolerance t;
+    t.rel = value;
+    return t;
+  }
+  static ZTolerance ulps(uint64_t value) {
+    ZTolerance t;
+    t.ulp = value;
+    return t;
+  }
+};
+
+struct ZCompareReport {
+  static constexpr size_t kMaxShown = 8; // 报告中列出的前若干个不匹配
+
+  size_t expected_size = 0;
+  size_t actual_size = 0;
+  size_t mismatches = 0;
+  size_t worst_index = 0;
+  double max_error = 0.0;
+  std::array<size_t, kMaxShown> first{};
+  size_t shown = 0;
+  // 失败时才填充的描述文本
+  std::string expected;
+  std::string actual;
+
+  bool ok() const { return mismatches == 0 && expected_size == actual_size; }
+
+  void record(size_t index, double error) {
+    if (shown < kMaxShown)
+      first[shown++] = index;
+    if (mismatches == 0 || error > max_error) {
+      max_error = error;
+      worst_index = index;
+    }
+    ++mismatches;
+  }
+};
+
+class ZArrayCompare {
+public:
+  static constexpr size_t kBlock = 64;
+
+  /**
+   * @description: 逐元素精确比较两个连续序列（vector、array、span等）
+   * @return 比较结果，失败时附带描述
+   */
+  template <typename E, typename A>
+  static ZCompareReport equal(const E &expected, const A &actual) {
+    auto e = std::span(expected);
+    auto a = std::span(actual);
+    using T = std::remove_cv_t<typename decltype(e)::element_type>;
+    static_assert(
+        std::is_same_v<T, std::remove_cv_t<typename decltype(a)::element_type>>,
+        "EXPECT_ARRAY_EQ requires arrays of the same element type");
+    ZCompareReport report = begin(e.size(), a.size());
+    const size_t n = std::min(e.size(), a.size());
+    if constexpr (std::has_unique_object_representations_v<T>) {
+      // 无填充位的类型逐字节相等即值相等，memcmp 快速通过
+      if (n == 0 || std::memcmp(e.data(), a.data(), n * sizeof(T)) == 0) {
+        finish(report, e, a, "equal");
+        return report;
+      }
+    }
+    scan(e.data(), a.data(), n, report,
+         [](const T &x, const T &y) { return !(x == y); },
+         [](const T &x, const T &y) { return absError(x, y); });
+    finish(report, e, a, "equal");
+    return report;
+  }
+  /**
+   * @description: 逐元素近似比较两个浮点序列
+   * @param tolerance 绝对/相对/ULP容差
+   */
+  template <typename E, typename A>
+  static ZCompareReport near(const E &expected, const A &actual,
+                             const ZTolerance &tolerance) {
+    auto e = std::span(expected);
+    auto a = std::span(actual);
+    using T = std::remove_cv_t<typename decltype(e)::element_type>;
+    static_assert(std::is_arithmetic_v<T>,
+                  "EXPECT_ARRAY_NEAR requires arithmetic elements");
+    static_assert(
+        std::is_same_v<T, std::remove_cv_t<typename decltype(a)::element_type>>,
+        "EXPECT_ARRAY_NEAR requires arrays of the same element type");
+    ZCompareReport report = begin(e.size(), a.size());
+    const size_t n = std::min(e.size(), a.size());
+    const double abs_tol = tolerance.abs, rel_tol = tolerance.rel;
+    const uint64_t ulp_tol = tolerance.ulp;
+    // NaN 参与的比较结果为假，因此总被计为不匹配
+    auto outside = [=](const T &x, const T &y) {
+      const double diff = std::fabs(double(x) - double(y));
+      return !(diff <= abs_tol ||
+               diff <= rel_tol * std::max(std::fabs(double(x)),
+                                          std::fabs(double(y))));
+    };
+    if (ulp_tol == 0)
+      scan(e.data(), a.data(), n, report, outside,
+           [](const T &x, const T &y) { return absError(x, y); });
+    else if (abs_tol == 0.0 && rel_tol == 0.0)
+      scan(e.data(), a.data(), n, report,
+           [=](const T &x, const T &y) { return ulpDistance(x, y) > ulp_tol; },
+           [](const T &x, const T &y) { return double(ulpDistance(x, y)); });
+    else
+      scan(e.data(), a.data(), n, report,
+           [=](const T &x, const T &y) {
+             return outside(x, y) && ulpDistance(x, y) > ulp_tol;
+           },
+           [](const T &x, const T &y) { return absError(x, y); });
+    finish(report, e, a, describe(tolerance));
+    return report;
+  }
+  /**
+   * @description: 逐字节比较两个缓冲区
+   */
+  template <typename E, typename A>
+  static ZCompareReport bytes(const E &expected, const A &actual) {
+    auto e = std::as_bytes(std::span(expected));
+    auto a = std::as_bytes(std::span(actual));
+    auto *x = reinterpret_cast<const uint8_t *>(e.data());
+    auto *y = reinterpret_cast<const uint8_t *>(a.data());
+    ZCompareReport report = begin(e.size(), a.size());
+    const size_t n = std::min(e.size(), a.size());
+    if (n > 0 && std::memcmp(x, y, n) != 0)
+      scanBytes(x, y, n, report);
+    finish(report, std::span(x, e.size()), std::span(y, a.size()), "equal");
+    return report;
+  }
+  /**
+   * @description: 两个浮点数之间相差的可表示值个数，NaN 视为无穷远
+   */
+  template <typename T> static uint64_t ulpDistance(T x, T y) {
+    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+      if (std::isnan(x) || std::isnan(y))
+        return std::numeric_limits<uint64_t>::max();
+      const int64_t ox = ordered(x), oy = ordered(y);
+      return ox >= oy ? uint64_t(ox) - uint64_t(oy)
+                      : uint64_t(oy) - uint64_t(ox);
+    } else {
+      const double d = absError(x, y);
+      return d >= 1.8e19 ? std::numeric_limits<uint64_t>::max() : uint64_t(d);
+    }
+  }
+
+private:
+  static ZCompareReport begin(size_t expected_size, size_t actual_size) {
+    ZCompareReport report;
+    report.expected_size = expected_size;
+    report.actual_size = actual_size;
+    return report;
+  }
+  /**
+   * @description: 块内先做无分支计数，只有计数非零的块才逐元素记录
+   */
+  template <typename T, typename Mismatch, typename Error>
+  static void scan(const T *x, const T *y, size_t n, ZCompareReport &report,
+                   Mismatch mismatch, Error error) {
+    size_t i = 0;
+    for (; i + kBlock <= n; i += kBlock) {
+      bool bad = false;
+      for (size_t j = 0; j < kBlock; ++j)
+        bad |= mismatch(x[i + j], y[i + j]);
+      if (bad)
+        locate(x, y, i, i + kBlock, report, mismatch, error);
+    }
+    locate(x, y, i, n, report, mismatch, error);
+  }
+
+  template <typename T, typename Mismatch, typename Error>
+  static void locate(const T *x, const T *y, size_t from, size_t to,
+                     ZCompareReport &report, Mismatch mismatch, Error error) {
+    for (size_t i = from; i < to; ++i)
+      if (mismatch(x[i], y[i]))
+        report.record(i, error(x[i], y[i]));
+  }
+
+  static void recordMask(const uint8_t *x, const uint8_t *y, size_t base,
+                         uint32_t mask, ZCompareReport &report) {
+    while (mask) {
+      const size_t i = base + std::countr_zero(mask);
+      report.record(i, std::abs(int(x[i]) - int(y[i])));
+      mask &= mask - 1;
+    }
+  }
+
+#if defined(__x86_64__) || defined(__i386__)
+  __attribute__((target("avx2"))) static size_t
+  scanBytesAvx2(const uint8_t *x, const uint8_t *y, size_t n,
+                ZCompareReport &report) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+      __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i));
+      uint32_t mask = ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+      if (mask)
+        recordMask(x, y, i, mask, report);
+    }
+    return i;
+  }
+
+  static size_t scanBytesSse2(const uint8_t *x, const uint8_t *y, size_t n,
+                              ZCompareReport &report) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+      __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i));
+      __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i));
+      uint32_t mask =
+          ~uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) & 0xFFFFu;
+      if (mask)
+        recordMask(x, y, i, mask, report);
+    }
+    return i;
+  }
+#endif
+
+  static void scanBytes(const uint8_t *x, const uint8_t *y, size_t n,
+                        ZCompareReport &report) {
+    size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    i = has_avx2 ? scanBytesAvx2(x, y, n, report)
+                 : scanBytesSse2(x, y, n, report);
+#endif
+    for (; i < n; ++i)
+      if (x[i] != y[i])
+        report.record(i, std::abs(int(x[i]) - int(y[i])));
+  }
+
+  template <typename T> static double absError(const T &x, const T &y) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      const double d = double(x) - double(y);
+      return std::isnan(d) ? std::numeric_limits<double>::infinity()
+                           : std::fabs(d);
+    } else {
+      return 1.0;
+    }
+  }
+  /**
+   * @description: 将浮点数的位模式映射为单调的整数，相邻浮点数相差1
+   */
+  template <typename T> static int64_t ordered(T value) {
+    if constexpr (std::is_same_v<T, float>) {
+      const int32_t bits = std::bit_cast<int32_t>(value);
+      return bits < 0 ? int64_t(std::numeric_limits<int32_t>::min()) - bits
+                      : bits;
+    } else {
+      const int64_t bits = std::bit_cast<int64_t>(value);
+      return bits < 0 ? std::numeric_limits<int64_t>::min() - bits : bits;
+    }
+  }
+
+  static std::string describe(const ZTolerance &t) {
+    std::ostringstream out;
+    out << "within";
+    const char *sep = " ";
+    if (t.abs > 0 || (t.rel == 0 && t.ulp == 0)) {
+      out << sep << "abs " << t.abs;
+      sep = " or ";
+    }
+    if (t.rel > 0) {
+      out << sep << "rel " << t.rel;
+      sep = " or ";
+    }
+    if (t.ulp > 0)
+      out << sep << t.ulp << " ulp";
+    return out.str();
+  }
+
+  template <typename T> static std::string text(const T &value) {
+    if constexpr (std::is_same_v<T, uint8_t> || std::is_same_v<T, std::byte>) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "0x%02x", unsigned(value));
+      return buf;
+    } else if constexpr (std::is_floating_point_v<T>) {
+      char buf[32];
+      std::snprintf(buf, sizeof(buf), "%.9g", double(value));
+      return buf;
+    } else if constexpr (requires(std::ostream &os) { os << value; }) {
+      std::ostringstream out;
+      out << value;
+      return out.str();
+    } else {
+      return "<" + std::to_string(sizeof(T)) + "-byte object>";
+    }
+  }
+  /**
+   * @description: 失败时生成期望和实际描述：不匹配数量、最大误差及其位置、
+   *               前若干个不匹配的元素
+   */
+  template <typename T, typename U>
+  static void finish(ZCompareReport &report, std::span<T> e, std::span<U> a,
+                     const std::string &mode) {
+    if (report.ok())
+      return;
+    std::ostringstream expected, actual;
+    expected << report.expected_size << " elements " << mode;
+    if (report.expected_size != report.actual_size)
+      actual << "size " << report.actual_size << " (expected "
+             << report.expected_size << ")";
+    if (report.mismatches > 0) {
+      if (report.expected_size != report.actual_size)
+        actual << "; ";
+      actual << report.mismatches << " of "
+             << std::min(report.expected_size, report.actual_size)
+             << " elements differ, max error " << report.max_error
+             << " at [" << report.worst_index << "]: "
+             << text(e[report.worst_index]) << " vs "
+             << text(a[report.worst_index]) << "; first:";
+      for (size_t k = 0; k < report.shown; ++k) {
+        const size_t i = report.first[k];
+        actual << (k ? ", [" : " [") << i << "] " << text(e[i]) << " vs "
+               << text(a[i]);
+      }
+      if (report.mismatches > report.shown)
+        actual << ", ...";
+    }
+    report.expected = expected.str();
+    report.actual = actual.str();
+  }
+};
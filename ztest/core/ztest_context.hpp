@@ -1,10 +1,19 @@
 #pragma once
+#include "ztest_assert.hpp"
 #include "ztest_base.hpp"
 #include "ztest_logger.hpp"
+#include "ztest_cache.hpp"
+#include "ztest_fixture.hpp"
+#include "ztest_prefetch.hpp"
+#include "ztest_report.hpp"
 #include "ztest_result.hpp"
+#include "ztest_scheduler.hpp"
+#include "ztest_stream.hpp"
 #include "ztest_thread.hpp"
+#include <future>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <string>
 #include <thread>
@@ -21,6 +30,10 @@ private:
   queue<shared_ptr<ZTestBase>> _test_queue;
   vector<shared_ptr<ZTestBase>> _test_list;
   TestView *_visualizer;
+  future<void> _report_future; // 后台报告生成任务
+  // 本轮 runAllTests 中已提交结果的状态，供依赖查询使用；结果管理器中还有 GUI 的
+  // z_unknown 占位和上一轮运行的旧结果，不能作为依赖是否完成的依据
+  unordered_map<string, ZState> _run_states;
 
 public:
   /**
@@ -29,6 +42,79 @@ public:
    * @return none
    */
   void setVisualizer(TestView *visualizer) { _visualizer = visualizer; }
+  /**
+   * @description: 提交测试结果并同步到结果缓存
+   * @param test 测试用例
+   * @param result 测试结果
+   */
+  void commitResult(const shared_ptr<ZTestBase> &test, ZTestResult &&result) {
+    test->annotateResult(result);
+    ZFixture::finishTest(*test, result);
+    ZResultCache::instance().store(*test, result);
+    vector<ZTestResult> children;
+    test->takeChildResults(children);
+    std::lock_guard<std::mutex> lock(_result_mutex);
+    _run_states[result.getName()] = result.getState();
+    ZTestResultManager::getInstance().addResult(std::move(result));
+    for (auto &child : children) {
+      _run_states[child.getName()] = child.getState();
+      ZTestResultManager::getInstance().addResult(std::move(child));
+    }
+  }
+  /**
+   * @description: 结果缓存命中时直接复用缓存结果，跳过测试执行
+   * @param test 测试用例
+   * @return 命中返回true
+   */
+  bool reuseCachedResult(const shared_ptr<ZTestBase> &test) {
+    ZTestResult cached;
+    if (!ZResultCache::instance().lookup(*test, cached))
+      return false;
+    logger.info("[Cache] Reusing cached result: " + test->getName());
+    std::lock_guard<std::mutex> lock(_result_mutex);
+    _run_states[cached.getName()] = cached.getState();
+    ZTestResultManager::getInstance().addResult(std::move(cached));
+    return true;
+  }
+  /**
+   * @description: 查询测试在本轮运行中的结果状态
+   * @param name 测试全名
+   * @return 本轮尚未提交结果时为空
+   */
+  optional<ZState> runState(const string &name) {
+    std::lock_guard<std::mutex> lock(_result_mutex);
+    auto it = _run_states.find(name);
+    if (it == _run_states.end())
+      return nullopt;
+    return it->second;
+  }
+  /**
+   * @description: 串行运行的测试（unsafe、基准、参数化）不经过调度器，运行前检查
+   *               dependsOn：依赖须在本轮中先于它运行并通过，否则提交跳过结果。
+   *               串行阶段同一时刻只运行一个测试，锁和信号量的声明自然满足
+   * @param test 测试用例
+   * @param phase 日志中的阶段名
+   * @return 依赖满足返回true
+   */
+  bool checkDependencies(const shared_ptr<ZTestBase> &test,
+                         const string &phase) {
+    for (const auto &dep : test->getDependencies()) {
+      const optional<ZState> state = runState(dep);
+      if (state == ZState::z_success)
+        continue;
+      const string reason = state ? "Dependency " + dep + " failed"
+                                  : "Dependency " + dep +
+                                        " has not run before this test";
+      ZTestResult result;
+      result.setResult(test->getName(), test->getType(), ZState::z_failed,
+                       "Skipped: " + reason, {}, {}, 0);
+      commitResult(test, std::move(result));
+      logger.error("[" + phase + "] Test skipped: " + test->getName() + " - " +
+                   reason);
+      return false;
+    }
+    return true;
+  }
   /**
    * @description: 运行所有 z_unsafe 测试, 线程不安全/性能测试
    * @return none
@@ -41,24 +127,37 @@ public:
       if (test->getType() == ZType::z_unsafe) {
         total++;
         const string &test_name = test->getName();
+        if (reuseCachedResult(test)) {
+          succeeded++;
+          continue;
+        }
+        if (!checkDependencies(test, "Unsafe")) {
+          failed++;
+          continue;
+        }
         logger.debug("[Unsafe] Running test: " + test_name);
 
+        ZAssertScope asserts(*test);
         try {
           ZTimer timer;
           timer.start();
-          test->run();
+          ZState state = asserts.finalState(test->run());
           timer.stop();
 
           ZTestResult result;
-          result.setResult(test_name, ZType::z_safe, ZState::z_success, "",
+          result.setResult(test_name, ZType::z_safe, state, asserts.message(),
                            timer.getStartTime(), timer.getEndTime(),
                            timer.getElapsedMilliseconds());
+          result.setFailures(asserts.failures());
 
-          {
-            std::lock_guard<std::mutex> lock(_result_mutex);
-            ZTestResultManager::getInstance().addResult(std::move(result));
-          }
+          commitResult(test, std::move(result));
 
+          if (state == ZState::z_failed) {
+            failed++;
+            logger.error("[Unsafe] Test failed: " + test_name +
+                         " - Reason: " + asserts.message());
+            continue;
+          }
           succeeded++;
           logger.info("[Unsafe] Test succeeded: " + test_name + " (" +
                       to_string(timer.getElapsedMilliseconds()) + "ms)");
@@ -66,16 +165,14 @@ public:
         } catch (const std::exception &e) {
           ZTestResult result;
           result.setResult(test_name, ZType::z_unsafe, ZState::z_failed,
-                           e.what(), {}, {}, 0);
+                           asserts.message(e.what()), {}, {}, 0);
+          result.setFailures(asserts.failures(e.what()));
 
-          {
-            std::lock_guard<std::mutex> lock(_result_mutex);
-            ZTestResultManager::getInstance().addResult(std::move(result));
-          }
+          commitResult(test, std::move(result));
 
           failed++;
           logger.error("[Unsafe] Test failed: " + test_name +
-                       " - Reason: " + e.what());
+                       " - Reason: " + asserts.message(e.what()));
         }
       }
     }
@@ -98,14 +195,17 @@ public:
           _test_list.begin(), _test_list.end(), std::back_inserter(safe_tests),
           [](const auto &test) { return test->getType() == ZType::z_safe; });
     }
+    safe_tests.erase(std::remove_if(safe_tests.begin(), safe_tests.end(),
+                                    [this](const auto &test) {
+                                      return reuseCachedResult(test);
+                                    }),
+                     safe_tests.end());
 
-    const unsigned num_workers =
-        std::max(1u, min(std::thread::hardware_concurrency(), 8u));
-    ZThreadPool pool(num_workers);
-    std::vector<std::future<void>> futures;
+    ZThreadPool &pool = ZThreadPool::shared();
     logger.info("[Safe] Starting parallel execution of " +
                 std::to_string(safe_tests.size()) + " safe tests using " +
-                std::to_string(num_workers) + " workers");
+                std::to_string(pool.size()) + " workers" +
+                (ZAffinity::options().pin_workers ? " (pinned)" : ""));
     // std::thread status_monitor([&pool]() {
     //   while (!pool.is_stopped()) {
     //     pool.log_status();
@@ -113,12 +213,18 @@ public:
     //   }
     // });
 
-    for (auto &test : safe_tests) {
-      futures.emplace_back(pool.enqueue([this, test] { runTest(test); }));
-    }
-    for (auto &future : futures) {
-      future.get();
-    }
+    // 按 dependsOn 和资源声明调度，没有依赖的测试立即并行运行
+    ZTestScheduler(pool).run(
+        safe_tests, [this](const auto &test) { return runTest(test); },
+        [this](const auto &test, const string &reason) {
+          ZTestResult result;
+          result.setResult(test->getName(), test->getType(), ZState::z_failed,
+                           "Skipped: " + reason, {}, {}, 0);
+          commitResult(test, std::move(result));
+          logger.error("[Safe] Test skipped: " + test->getName() + " - " +
+                       reason);
+        },
+        [this](const string &name) { return runState(name); });
     // status_monitor.join();
     logger.info("[Safe] Parallel execution completed");
   }
@@ -131,6 +237,10 @@ public:
         total++;
         const string &test_name = test->getName();
         auto benchmark = dynamic_pointer_cast<ZBenchMark>(test);
+        if (!checkDependencies(test, "Benchmark")) {
+          failed++;
+          continue;
+        }
         logger.debug("[Benchmark] Running test: " + test_name);
 
         try {
@@ -142,13 +252,20 @@ public:
           ZTestResult result;
           result.setResult(test_name, ZType::z_benchmark, ZState::z_success, "",
                            timer.getStartTime(), timer.getEndTime(),
-                           timer.getElapsedMilliseconds(),
-                           benchmark->getIterations());
+                           benchmark->getMeasuredTime(),
+                           std::max<uint64_t>(
+                               1, benchmark->getCompletedIterations()));
           result.setIterationTimestamps(benchmark->getIterationTimestamps());
-          {
-            std::lock_guard<std::mutex> lock(_result_mutex);
-            ZTestResultManager::getInstance().addResult(std::move(result));
-          }
+          result.setEnvironment(benchmark->getEnvironment());
+          result.setScaling(benchmark->getScaling());
+          result.setCounters(benchmark->getCounters());
+          if (const auto &soak = benchmark->getSoak())
+            result.setSoak(*soak);
+          if (const auto &load = benchmark->getLoad())
+            result.setLoad(*load);
+          if (const auto &cold = benchmark->getColdStart())
+            result.setColdStart(*cold);
+          commitResult(test, std::move(result));
 
           succeeded++;
           logger.info("[Benchmark] Test succeeded: " + test_name +
@@ -159,10 +276,7 @@ public:
           ZTestResult result;
           result.setResult(test_name, ZType::z_benchmark, ZState::z_failed,
                            e.what(), {}, {}, 0, 1);
-          {
-            std::lock_guard<std::mutex> lock(_result_mutex);
-            ZTestResultManager::getInstance().addResult(std::move(result));
-          }
+          commitResult(test, std::move(result));
 
           failed++;
           logger.error("[Benchmark] Test failed: " + test_name +
@@ -183,28 +297,54 @@ public:
     logger.debug("[Parameterized] Starting parameterized tests execution");
     size_t total = 0, succeeded = 0, failed = 0;
 
+    std::vector<shared_ptr<ZTestBase>> param_tests;
     for (auto &test : _test_list) {
       if (test->getType() == ZType::z_param) {
         total++;
+        if (reuseCachedResult(test))
+          succeeded++;
+        else
+          param_tests.push_back(test);
+      }
+    }
+    // 预取窗口：运行第 i 个测试时，后台加载其后 depth 个测试的数据集
+    const size_t depth = ZDataPrefetcher::instance().getDepth();
+    for (size_t i = 0; i < param_tests.size() && i < depth; ++i)
+      param_tests[i]->prefetchData();
+
+    for (size_t index = 0; index < param_tests.size(); ++index) {
+      {
+        auto &test = param_tests[index];
+        if (index + depth < param_tests.size())
+          param_tests[index + depth]->prefetchData();
         const string &test_name = test->getName();
+        if (!checkDependencies(test, "Parameterized")) {
+          failed++;
+          continue;
+        }
         logger.debug("[Parameterized] Running test: " + test_name);
 
+        ZAssertScope asserts(*test);
         try {
           ZTimer timer;
           timer.start();
-          test->run();
+          ZState state = asserts.finalState(test->run());
           timer.stop();
 
           ZTestResult result;
-          result.setResult(test_name, ZType::z_param, ZState::z_success, "",
+          result.setResult(test_name, ZType::z_param, state, asserts.message(),
                            timer.getStartTime(), timer.getEndTime(),
                            timer.getElapsedMilliseconds());
+          result.setFailures(asserts.failures());
 
-          {
-            std::lock_guard<std::mutex> lock(_result_mutex);
-            ZTestResultManager::getInstance().addResult(std::move(result));
-          }
+          commitResult(test, std::move(result));
 
+          if (state == ZState::z_failed) {
+            failed++;
+            logger.error("[Parameterized] Test failed: " + test_name +
+                         " - Reason: " + asserts.message());
+            continue;
+          }
           succeeded++;
           logger.info("[Parameterized] Test succeeded: " + test_name + " (" +
                       to_string(timer.getElapsedMilliseconds()) + "ms)");
@@ -212,16 +352,14 @@ public:
         } catch (const std::exception &e) {
           ZTestResult result;
           result.setResult(test_name, ZType::z_param, ZState::z_failed,
-                           e.what(), {}, {}, 0);
+                           asserts.message(e.what()), {}, {}, 0);
+          result.setFailures(asserts.failures(e.what()));
 
-          {
-            std::lock_guard<std::mutex> lock(_result_mutex);
-            ZTestResultManager::getInstance().addResult(std::move(result));
-          }
+          commitResult(test, std::move(result));
 
           failed++;
           logger.error("[Parameterized] Test failed: " + test_name +
-                       " - Reason: " + e.what());
+                       " - Reason: " + asserts.message(e.what()));
         }
       }
     }
@@ -255,13 +393,14 @@ public:
   /**
    * @description: 运行单个测试样例
    * @param {shared_ptr<ZTestBase>} test_case
-   * @return {*}
+   * @return 测试的最终状态
    */
-  void runTest(shared_ptr<ZTestBase> test_case) {
+  ZState runTest(shared_ptr<ZTestBase> test_case) {
     ZTestResult result;
     ZTimer local_timer;
     auto *test_ptr = test_case.get();
     const string test_name = test_ptr->getName();
+    ZAssertScope asserts(*test_ptr);
 
     try {
       {
@@ -291,7 +430,8 @@ public:
 
         // 获取迭代次数和时间戳
         const auto &timestamps = benchmark->getIterationTimestamps();
-        int iterations = timestamps.size();
+        uint64_t iterations =
+            std::max<uint64_t>(1, benchmark->getCompletedIterations());
 
         // 构造最终结果
         local_timer.stop();
@@ -300,20 +440,31 @@ public:
           result.setResult(test_name, test_ptr->getType(), ZState::z_success,
                            "", local_timer.getStartTime(),
                            local_timer.getEndTime(),
-                           local_timer.getElapsedMilliseconds(), iterations);
+                           benchmark->getMeasuredTime(), iterations);
           result.setIterationTimestamps(timestamps); // 设置所有迭代时间
+          result.setEnvironment(benchmark->getEnvironment());
+          result.setScaling(benchmark->getScaling());
+          result.setCounters(benchmark->getCounters());
+          if (const auto &soak = benchmark->getSoak())
+            result.setSoak(*soak);
+          if (const auto &load = benchmark->getLoad())
+            result.setLoad(*load);
+          if (const auto &cold = benchmark->getColdStart())
+            result.setColdStart(*cold);
         }
 
       } else {
         // 其他类型测试正常执行一次
-        auto test_state = test_case->run();
+        auto test_state = asserts.finalState(test_case->run());
         local_timer.stop();
 
         {
           lock_guard<mutex> lock(_result_mutex);
-          result.setResult(test_name, test_ptr->getType(), test_state, "",
+          result.setResult(test_name, test_ptr->getType(), test_state,
+                           asserts.message(),
                            local_timer.getStartTime(), local_timer.getEndTime(),
                            local_timer.getElapsedMilliseconds());
+          result.setFailures(asserts.failures());
         }
       }
 
@@ -327,18 +478,21 @@ public:
     } catch (const exception &e) {
       lock_guard<mutex> lock(_result_mutex);
       result.setResult(test_ptr->getName(), test_ptr->getType(),
-                       ZState::z_failed, e.what(), local_timer.getStartTime(),
+                       ZState::z_failed, asserts.message(e.what()),
+                       local_timer.getStartTime(),
                        local_timer.getEndTime(),
                        local_timer.getElapsedMilliseconds());
+      result.setFailures(asserts.failures(e.what()));
       logger.error(result.getResultString(test_name) + "\n");
       logger.error(
           "Test [" + test_case->getName() + "] failed in thread " +
           ZThreadPool::thread_id_to_string(std::this_thread::get_id()) + ": " +
-          e.what());
+          result.getErrorMsg());
     }
 
-    lock_guard<mutex> lock(_result_mutex);
-    ZTestResultManager::getInstance().addResult(std::move(result));
+    const ZState state = result.getState();
+    commitResult(test_case, std::move(result));
+    return state;
   }
   /**
    * @description: 运行所有测试
@@ -346,17 +500,45 @@ public:
    */
   void runAllTests(bool generateHtml = true, bool generateJson = true,
                    bool generateJUnit = true) {
+    waitForReports();
+    {
+      std::lock_guard<std::mutex> lock(_result_mutex);
+      _run_states.clear();
+    }
+    {
+      std::lock_guard<std::mutex> lock(_list_mutex);
+      ZFixture::beginRun(_test_list);
+    }
     runUnsafeOnly();
     runSafeInParallel();
     runBenchmarkOnly();
     runParameterizedInSerial();
-
-    if (generateHtml)
-      logger.generateHtmlReport("test_report.html", true);
-    if (generateJson)
-      logger.generateJsonReport();
-    if (generateJUnit)
-      logger.generateJUnitReport();
+    ZFixture::endRun();
+
+    ZResultStream::instance().sync();
+    ZResultCache::instance().save();
+
+    ZReportOptions options;
+    options.html = generateHtml;
+    options.json = generateJson;
+    options.junit = generateJUnit;
+    options.testFilePath = logger.getTestFilePath();
+    _report_future = std::async(std::launch::async, [options]() {
+      ZReportWriter(options).write();
+    });
+  }
+  /**
+   * @description: 等待后台报告生成完成
+   * @return none
+   */
+  void waitForReports() {
+    if (!_report_future.valid())
+      return;
+    try {
+      _report_future.get();
+    } catch (const exception &e) {
+      logger.error(string("Report generation failed: ") + e.what());
+    }
   }
   /**
    * @description: 运行选定的测试
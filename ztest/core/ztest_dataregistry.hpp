@@ -1,59 +1,100 @@
 #pragma once
 #include "ztest_parameterized.hpp"
+#include <array>
+#include <atomic>
+#include <future>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <sys/stat.h>
 #include <unordered_map>
 // ZDataRegistry
 // 类是一个数据注册与缓存管理类，采用单例模式实现，用于管理测试数据的加载和缓存
+// 缓存按路径哈希分片加锁，按字节预算做近似全局LRU淘汰；
+// 同一文件的并发加载只解析一次，其余请求等待同一个加载结果。
 class ZDataRegistry {
 public:
+  static constexpr size_t kShardCount = 16;
+
   static ZDataRegistry &instance() {
     static ZDataRegistry reg;
     return reg;
   }
-  void setMaxSize(size_t max) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _max_size = max;
-    logger.info("Set LRU cache max size to: " + std::to_string(max));
+  /**
+   * @description: 设置缓存的内存预算
+   * @param bytes 字节数，等于0的时候不启用LRU淘汰
+   */
+  void setMemoryBudget(size_t bytes) {
+    _budget = bytes;
+    logger.info("Set data cache memory budget to: " +
+                std::to_string(bytes / 1024) + " KB");
+    evictToBudget("");
   }
 
   template <typename T> std::shared_ptr<T> load(const std::string &filePath) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    Shard &shard = shardFor(filePath);
+    std::unique_lock<std::mutex> lock(shard.mutex);
 
     logger.debug("Checking cache for: " + filePath);
     /**
      * @description: LRU访问更新
      */
-    if (auto it = _cache_map.find(filePath); it != _cache_map.end()) {
+    if (auto it = shard.entries.find(filePath); it != shard.entries.end()) {
       logger.debug("Cache hit for: " + filePath);
-      _lru_list.splice(_lru_list.begin(), _lru_list, it->second.second);
-      return std::static_pointer_cast<T>(it->second.first);
+      _hit_count++;
+      it->second.last_access = ++_clock;
+      shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_pos);
+      return std::static_pointer_cast<T>(it->second.data);
     }
     /**
-     * @description: 创建新加载器
+     * @description: 已有线程在加载同一文件时等待其结果
      */
+    if (auto it = shard.in_flight.find(filePath);
+        it != shard.in_flight.end()) {
+      auto pending = it->second;
+      lock.unlock();
+      logger.debug("Joining in-flight load for: " + filePath);
+      _hit_count++;
+      return std::static_pointer_cast<T>(pending.get());
+    }
+    /**
+     * @description: 创建新加载器，解析过程不持有分片锁
+     */
+    _miss_count++;
+    std::promise<std::shared_ptr<ZDataManager>> promise;
+    shard.in_flight.emplace(filePath, promise.get_future().share());
+    lock.unlock();
+
     logger.info("Loading new file: " + filePath);
-    auto loader = std::make_shared<T>(filePath);
-    _lru_list.push_front(filePath);
+    std::shared_ptr<T> loader;
+    try {
+      loader = std::make_shared<T>(filePath);
+    } catch (...) {
+      lock.lock();
+      shard.in_flight.erase(filePath);
+      lock.unlock();
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+    const size_t bytes = loader->memoryFootprint();
     /**
      * @description: 插入新条目
      */
+    lock.lock();
+    shard.lru.push_front(filePath);
+    shard.entries[filePath] = {loader, shard.lru.begin(), bytes, ++_clock};
+    shard.in_flight.erase(filePath);
+    lock.unlock();
+    _used_bytes += bytes;
+    promise.set_value(loader);
 
-    _cache_map[filePath] = {loader, _lru_list.begin()};
     logger.debug("Cached file: " + filePath +
-                 " | Size: " + std::to_string(loader->size()));
-
+                 " | Size: " + std::to_string(loader->size()) +
+                 " | Memory: " + std::to_string(bytes / 1024) + " KB");
     /**
      * @description: LRU淘汰
      */
-    if (_max_size > 0 && _cache_map.size() > _max_size) {
-      auto last = _lru_list.back();
-      logger.debug("Evicting LRU cache item: " + last);
-      _cache_map.erase(last);
-      _lru_list.pop_back();
-    }
-
+    evictToBudget(filePath);
     return loader;
   }
   /**
@@ -61,47 +102,149 @@ public:
    */
 
   template <typename T> std::shared_ptr<T> get(const std::string &filePath) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    Shard &shard = shardFor(filePath);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     logger.debug("Getting cache for: " + filePath);
-    if (auto it = _cache_map.find(filePath); it != _cache_map.end()) {
-      return std::static_pointer_cast<T>(it->second);
+    if (auto it = shard.entries.find(filePath); it != shard.entries.end()) {
+      return std::static_pointer_cast<T>(it->second.data);
     }
     return nullptr;
   }
+  /**
+   * @description: 获取文件的内容哈希（结果缓存计算键时使用）。首次请求时才读取文件，
+   *               之后文件的修改时间和大小不变时复用上次的哈希
+   * @param filePath 文件路径
+   * @return 文件内容哈希，文件不存在时为0
+   */
+  uint64_t fileHash(const std::string &filePath) {
+    struct stat st {};
+    if (::stat(filePath.c_str(), &st) != 0)
+      return 0;
+    const FileStamp stamp{static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                              st.st_mtim.tv_nsec,
+                          static_cast<uint64_t>(st.st_size), 0};
+    Shard &shard = shardFor(filePath);
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      if (auto it = shard.file_hashes.find(filePath);
+          it != shard.file_hashes.end() &&
+          it->second.mtime_ns == stamp.mtime_ns &&
+          it->second.size == stamp.size)
+        return it->second.hash;
+    }
+    FileStamp hashed = stamp;
+    hashed.hash = hashFileContent(filePath);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.file_hashes[filePath] = hashed;
+    return hashed.hash;
+  }
   /**
    * @description: 清空指定缓存
    */
 
   void clear(const std::string &filePath) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _cache_map.erase(filePath);
+    Shard &shard = shardFor(filePath);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (auto it = shard.entries.find(filePath); it != shard.entries.end())
+      eraseLocked(shard, it);
   }
+  /**
+   * @description: 获取缓存当前占用的字节数
+   */
+  size_t memoryUsage() const { return _used_bytes.load(); }
+
   void printCacheStats() const {
-    std::lock_guard<std::mutex> lock(_mutex);
-    size_t total_size = 0;
-    for (const auto &[path, entry] : _cache_map) {
-      total_size += entry.first->size() * sizeof(CSVCell);
+    size_t items = 0;
+    for (const auto &shard : _shards) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      items += shard.entries.size();
     }
+    const size_t hits = _hit_count.load(), misses = _miss_count.load();
 
     logger.info("LRU Cache Status:");
-    logger.info("- Max Size: " + std::to_string(_max_size));
-    logger.info("- Current Items: " + std::to_string(_cache_map.size()));
-    logger.info("- Total Memory: " + std::to_string(total_size / 1024) + " KB");
+    logger.info("- Memory Budget: " + std::to_string(_budget.load() / 1024) +
+                " KB");
+    logger.info("- Current Items: " + std::to_string(items));
+    logger.info("- Total Memory: " + std::to_string(_used_bytes.load() / 1024) +
+                " KB");
     logger.info("- Hit Rate: " +
-                std::to_string(_hit_count * 100 / (_hit_count + _miss_count)) +
+                std::to_string(hits + misses == 0
+                                   ? 0
+                                   : hits * 100 / (hits + misses)) +
                 "%");
   }
 
 private:
+  struct Entry {
+    std::shared_ptr<ZDataManager> data;
+    std::list<std::string>::iterator lru_pos;
+    size_t bytes;
+    uint64_t last_access;
+  };
+  // 文件哈希及计算时的修改时间和大小，两者变化时重新计算
+  struct FileStamp {
+    int64_t mtime_ns;
+    uint64_t size;
+    uint64_t hash;
+  };
+  struct Shard {
+    mutable std::mutex mutex;
+    std::list<std::string> lru;
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<std::string,
+                       std::shared_future<std::shared_ptr<ZDataManager>>>
+        in_flight;
+    std::unordered_map<std::string, FileStamp> file_hashes;
+  };
+
   ZDataRegistry() = default;
 
-  mutable std::mutex _mutex;
-  size_t _max_size = 0; // 等于0的时候不启用LRU,大于0的时候启用LRU
-  std::list<std::string> _lru_list;
-  std::unordered_map<std::string, std::pair<std::shared_ptr<ZDataManager>,
-                                            std::list<std::string>::iterator>>
-      _cache_map;
+  Shard &shardFor(const std::string &filePath) {
+    return _shards[std::hash<std::string>{}(filePath) % kShardCount];
+  }
+  /**
+   * @description: 在持有分片锁时移除条目
+   */
+  void eraseLocked(Shard &shard,
+                   std::unordered_map<std::string, Entry>::iterator it) {
+    _used_bytes -= it->second.bytes;
+    shard.lru.erase(it->second.lru_pos);
+    shard.entries.erase(it);
+  }
+  /**
+   * @description: 淘汰各分片LRU尾部中最久未访问的条目，直到满足内存预算
+   * @param keep 刚加载、不参与本轮淘汰的文件
+   */
+  void evictToBudget(const std::string &keep) {
+    const size_t budget = _budget.load();
+    while (budget > 0 && _used_bytes.load() > budget) {
+      Shard *victim = nullptr;
+      uint64_t oldest = UINT64_MAX;
+      for (auto &shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.lru.empty() || shard.lru.back() == keep)
+          continue;
+        const auto &entry = shard.entries.at(shard.lru.back());
+        if (entry.last_access < oldest) {
+          oldest = entry.last_access;
+          victim = &shard;
+        }
+      }
+      if (!victim)
+        break;
+      std::lock_guard<std::mutex> lock(victim->mutex);
+      if (victim->lru.empty() || victim->lru.back() == keep)
+        continue;
+      logger.debug("Evicting LRU cache item: " + victim->lru.back());
+      eraseLocked(*victim, victim->entries.find(victim->lru.back()));
+    }
+  }
+
+  std::array<Shard, kShardCount> _shards;
+  std::atomic<size_t> _budget{0}; // 等于0的时候不启用LRU,大于0的时候启用LRU
+  std::atomic<size_t> _used_bytes{0};
+  std::atomic<uint64_t> _clock{0};
 
-  mutable size_t _hit_count = 0;
-  mutable size_t _miss_count = 0;
+  std::atomic<size_t> _hit_count{0};
+  std::atomic<size_t> _miss_count{0};
 };
\ No newline at end of file
@@ -26,9 +26,22 @@ public:
         << "  Actual  : " << actual;
     _msg = oss.str();
   }
+  /**
+   * @description: 使用已格式化的完整信息构造异常
+   * @param message 异常信息
+   */
+  explicit ZTestFailureException(string message) : _msg(std::move(message)) {}
   /**
    * @description: 获取异常信息字符串
    * @return 异常信息的C风格字符串指针
    */
   const char *what() const noexcept override { return _msg.c_str(); }
-};
\ No newline at end of file
+};
+// ZFatalAssertion 是 z_record 模式下致命断言失败时抛出的轻量异常，
+// 失败的原始值已记录在断言缓冲区中，报告时才格式化，抛出时不分配内存
+class ZFatalAssertion : public std::exception {
+public:
+  const char *what() const noexcept override {
+    return "fatal assertion failed";
+  }
+};
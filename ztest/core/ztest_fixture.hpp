@@ -0,0 +1,221 @@
+#pragma once
+#include "ztest_assert.hpp"
+#include "ztest_base.hpp"
+#include "ztest_logger.hpp"
+#include "ztest_result.hpp"
+#include "ztest_thread.hpp"
+#include "ztest_timer.hpp"
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+// 共享夹具：构建代价高的只读数据在首次使用时构建一次，由同一作用域内的测试共享。
+// 作用域为整个运行、每个套件或每个工作线程；测试通过 useFixture 声明使用的夹具，
+// 最后一个声明者结束后夹具被释放（未声明就使用的夹具在运行结束时释放）。
+// 构建（及等待其它线程构建）的耗时单独记录，不计入测试时间。
+enum class ZFixtureScope { z_run, z_suite, z_thread };
+
+class ZFixture {
+public:
+  /**
+   * @description: 定义夹具
+   * @param name 夹具名
+   * @param scope 共享范围
+   * @param build 构建函数，返回的对象在释放时析构（可用自定义删除器做清理）
+   */
+  template <typename T>
+  static void define(const string &name, ZFixtureScope scope,
+                     function<shared_ptr<T>()> build) {
+    auto &s = state();
+    lock_guard<mutex> lock(s.guard);
+    s.definitions[name] = {scope, type_index(typeid(T)),
+                           [build = move(build)]() -> shared_ptr<void> {
+                             return build();
+                           }};
+  }
+  /**
+   * @description: 获取夹具，不存在时在当前线程上构建；构建失败时每个使用者都会收到同一异常
+   * @param name 夹具名
+   * @return 只读的共享对象
+   */
+  template <typename T> static shared_ptr<const T> get(const string &name) {
+    auto &s = state();
+    unique_lock<mutex> lock(s.guard);
+    auto def = s.definitions.find(name);
+    if (def == s.definitions.end())
+      throw runtime_error("Unknown fixture: " + name);
+    if (def->second.type != type_index(typeid(T)))
+      throw runtime_error("Fixture " + name + " requested with the wrong type");
+    const string key = instanceKey(name, def->second.scope);
+    if (auto it = s.instances.find(key); it != s.instances.end()) {
+      shared_future<shared_ptr<void>> value = it->second;
+      lock.unlock();
+      if (value.wait_for(chrono::seconds(0)) != future_status::ready) {
+        ZTimer timer;
+        timer.start();
+        value.wait();
+        timer.stop();
+        addBuildTime(timer.getElapsedMilliseconds());
+      }
+      return static_pointer_cast<const T>(value.get());
+    }
+    promise<shared_ptr<void>> built;
+    shared_future<shared_ptr<void>> value = built.get_future().share();
+    s.instances.emplace(key, value);
+    auto build = def->second.build;
+    lock.unlock();
+
+    ZTimer timer;
+    timer.start();
+    try {
+      built.set_value(build());
+    } catch (...) {
+      built.set_exception(current_exception());
+    }
+    timer.stop();
+    addBuildTime(timer.getElapsedMilliseconds());
+    logger.info("[Fixture] Built " + name + " in " +
+                to_string(timer.getElapsedMilliseconds()) + "ms");
+    return static_pointer_cast<const T>(value.get());
+  }
+  /**
+   * @description: 运行开始时按测试的声明统计每个夹具的使用者数
+   * @param tests 本次运行的测试
+   */
+  static void beginRun(const vector<shared_ptr<ZTestBase>> &tests) {
+    auto &s = state();
+    lock_guard<mutex> lock(s.guard);
+    s.users.clear();
+    for (const auto &test : tests)
+      for (const auto &name : test->getFixtures())
+        if (auto def = s.definitions.find(name); def != s.definitions.end())
+          ++s.users[userKey(name, def->second.scope, test->getName())];
+  }
+  /**
+   * @description: 测试结束时分离夹具构建时间，并释放已没有后续使用者的夹具
+   * @param test 结束的测试
+   * @param result 测试结果
+   */
+  static void finishTest(const ZTestBase &test, ZTestResult &result) {
+    if (const double elapsed = takeBuildTime(test); elapsed > 0)
+      result.separateFixtureTime(elapsed);
+    vector<shared_future<shared_ptr<void>>> released;
+    {
+      auto &s = state();
+      lock_guard<mutex> lock(s.guard);
+      for (const auto &name : test.getFixtures()) {
+        auto def = s.definitions.find(name);
+        if (def == s.definitions.end())
+          continue;
+        const ZFixtureScope scope = def->second.scope;
+        auto count = s.users.find(userKey(name, scope, test.getName()));
+        if (count == s.users.end() || --count->second > 0)
+          continue;
+        s.users.erase(count);
+        const size_t before = released.size();
+        // 线程作用域的夹具在所有线程的使用者都结束后一起释放
+        const string prefix =
+            scope == ZFixtureScope::z_suite
+                ? name + '\0' + ZTestResultManager::suiteOf(test.getName())
+                : name + '\0';
+        for (auto it = s.instances.begin(); it != s.instances.end();) {
+          if (scope == ZFixtureScope::z_suite ? it->first == prefix
+                                               : it->first.rfind(prefix, 0) == 0) {
+            released.push_back(move(it->second));
+            it = s.instances.erase(it);
+          } else {
+            ++it;
+          }
+        }
+        if (released.size() > before)
+          logger.info("[Fixture] Released " + name);
+      }
+    }
+    // 在锁外析构夹具对象
+    released.clear();
+  }
+  /**
+   * @description: 取出测试在当前线程上累计的夹具构建时间并清零
+   * @param test 测试用例
+   * @return 构建（及等待构建）的耗时（毫秒）
+   */
+  static double takeBuildTime(const ZTestBase &test) {
+    auto &times = buildTimes();
+    auto it = times.find(&test);
+    if (it == times.end())
+      return 0;
+    const double elapsed = it->second;
+    times.erase(it);
+    return elapsed;
+  }
+  /**
+   * @description: 运行结束时释放所有剩余的夹具
+   */
+  static void endRun() {
+    unordered_map<string, shared_future<shared_ptr<void>>> released;
+    {
+      auto &s = state();
+      lock_guard<mutex> lock(s.guard);
+      released.swap(s.instances);
+      s.users.clear();
+    }
+  }
+
+private:
+  struct Definition {
+    ZFixtureScope scope = ZFixtureScope::z_run;
+    type_index type = type_index(typeid(void));
+    function<shared_ptr<void>()> build;
+  };
+  struct State {
+    mutex guard;
+    unordered_map<string, Definition> definitions;
+    // 键为 夹具名\0作用域键
+    unordered_map<string, shared_future<shared_ptr<void>>> instances;
+    unordered_map<string, size_t> users;
+  };
+
+  static State &state() {
+    static State s;
+    return s;
+  }
+  // 当前线程上各测试累计的夹具构建时间（毫秒），按正在运行的测试区分：
+  // 套件子测试和等待期间代为执行的测试嵌套在另一个测试中运行，各自计时
+  static unordered_map<const ZTestBase *, double> &buildTimes() {
+    thread_local unordered_map<const ZTestBase *, double> times;
+    return times;
+  }
+  static void addBuildTime(double ms) {
+    if (const ZTestBase *owner = ZAssertBuffer::current().owner())
+      buildTimes()[owner] += ms;
+  }
+
+  static string instanceKey(const string &name, ZFixtureScope scope) {
+    switch (scope) {
+    case ZFixtureScope::z_suite: {
+      // 套件由当前线程上正在运行的测试确定
+      const ZTestBase *owner = ZAssertBuffer::current().owner();
+      return name + '\0' +
+             (owner ? ZTestResultManager::suiteOf(owner->getName()) : "");
+    }
+    case ZFixtureScope::z_thread:
+      return name + '\0' +
+             ZThreadPool::thread_id_to_string(this_thread::get_id());
+    default:
+      return name + '\0';
+    }
+  }
+
+  static string userKey(const string &name, ZFixtureScope scope,
+                        const string &test_name) {
+    if (scope == ZFixtureScope::z_suite)
+      return name + '\0' + ZTestResultManager::suiteOf(test_name);
+    return name + '\0';
+  }
+};
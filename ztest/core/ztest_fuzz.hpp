@@ -0,0 +1,459 @@
+#pragma once
+#include "ztest_base.hpp"
+#include "ztest_error.hpp"
+#include "ztest_logger.hpp"
+#include "ztest_thread.hpp"
+#include "ztest_utils.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+// 进程内覆盖率引导的模糊测试。
+// 覆盖率来自 SanitizerCoverage：clang 使用 -fsanitize-coverage=trace-pc-guard，
+// gcc 使用 -fsanitize-coverage=trace-pc（xmake f --fuzz=y）。回调把命中计入
+// 当前线程的 64K 计数表，未插桩时退化为无反馈的随机变异。
+// 普通运行只回放语料和崩溃用例（回归模式），以 --fuzz <秒> 运行时才生成新输入。
+
+#if defined(__has_attribute)
+#if __has_attribute(no_sanitize_coverage)
+#define ZTEST_NO_COVERAGE __attribute__((no_sanitize_coverage))
+#endif
+#endif
+#ifndef ZTEST_NO_COVERAGE
+#define ZTEST_NO_COVERAGE __attribute__((no_sanitize("coverage")))
+#endif
+
+constexpr size_t kCoverageMapSize = 1 << 16;
+// 当前线程的覆盖率计数表，只在模糊测试工作线程上非空
+inline thread_local uint8_t *ztest_coverage_map = nullptr;
+inline std::atomic<uint32_t> ztest_coverage_guards{0};
+
+extern "C" {
+ZTEST_NO_COVERAGE __attribute__((weak, used)) void
+__sanitizer_cov_trace_pc_guard_init(uint32_t *start, uint32_t *stop) {
+  if (start == stop || *start)
+    return;
+  for (uint32_t *guard = start; guard < stop; ++guard)
+    *guard = ztest_coverage_guards.fetch_add(1, std::memory_order_relaxed) %
+                 (kCoverageMapSize - 1) +
+             1;
+}
+
+ZTEST_NO_COVERAGE __attribute__((weak, used)) void
+__sanitizer_cov_trace_pc_guard(uint32_t *guard) {
+  if (uint8_t *map = ztest_coverage_map)
+    map[*guard]++;
+}
+
+ZTEST_NO_COVERAGE __attribute__((weak, used)) void __sanitizer_cov_trace_pc() {
+  if (uint8_t *map = ztest_coverage_map) {
+    const auto pc = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
+    map[(pc ^ (pc >> 16)) & (kCoverageMapSize - 1)]++;
+  }
+}
+}
+
+struct ZFuzzOptions {
+  double seconds = 0.0;    // 大于0时进入模糊测试模式
+  size_t workers = 0;      // 0 表示使用硬件线程数
+  size_t max_length = 4096; // 生成输入的最大长度
+  std::string root = "fuzz"; // 语料目录为 <root>/<测试名>/corpus，崩溃为 .../crashes
+};
+
+// 模糊测试的实时统计，供GUI资源监视器读取
+struct ZFuzzStats {
+  std::string target;
+  uint64_t execs = 0;
+  double execs_per_sec = 0.0;
+  size_t coverage = 0; // 覆盖到的计数表槽位数
+  size_t corpus = 0;
+  size_t crashes = 0;
+  bool active = false;
+};
+
+class ZFuzzMonitor {
+public:
+  static ZFuzzMonitor &instance() {
+    static ZFuzzMonitor monitor;
+    return monitor;
+  }
+  ZFuzzStats snapshot() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+  void update(const ZFuzzStats &stats) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats = stats;
+  }
+
+private:
+  ZFuzzMonitor() = default;
+  mutable std::mutex _mutex;
+  ZFuzzStats _stats;
+};
+
+// 变异策略：位翻转、字节替换、特殊值、插入、删除、块复制和与语料交叉
+class ZMutator {
+public:
+  explicit ZMutator(uint64_t seed) : _rng(seed) {}
+
+  void mutate(std::vector<uint8_t> &data, size_t max_length,
+              const std::vector<uint8_t> &other) {
+    const int rounds = 1 + static_cast<int>(_rng() % 4);
+    for (int r = 0; r < rounds; ++r) {
+      switch (data.empty() ? 4 : _rng() % 8) {
+      case 0: // 翻转一位
+        data[pick(data.size())] ^= uint8_t(1u << (_rng() % 8));
+        break;
+      case 1: // 随机字节
+        data[pick(data.size())] = uint8_t(_rng());
+        break;
+      case 2: { // 特殊值
+        static constexpr uint8_t interesting[] = {0,    1,    0x7f, 0x80,
+                                                  0xff, '0',  '9',  ',',
+                                                  '\n', '"', '-',  '.'};
+        data[pick(data.size())] = interesting[_rng() % sizeof(interesting)];
+        break;
+      }
+      case 3: // 数值加减
+        data[pick(data.size())] += uint8_t(int(_rng() % 35) - 17);
+        break;
+      case 4: // 插入字节
+        if (data.size() < max_length)
+          data.insert(data.begin() + pick(data.size() + 1), uint8_t(_rng()));
+        break;
+      case 5: { // 删除一段
+        const size_t at = pick(data.size());
+        const size_t n = 1 + pick(std::min<size_t>(16, data.size() - at));
+        data.erase(data.begin() + at, data.begin() + at + n);
+        break;
+      }
+      case 6: { // 复制一段到另一位置
+        const size_t from = pick(data.size());
+        const size_t n = 1 + pick(std::min<size_t>(32, data.size() - from));
+        if (data.size() + n > max_length)
+          break;
+        std::vector<uint8_t> chunk(data.begin() + from, data.begin() + from + n);
+        data.insert(data.begin() + pick(data.size() + 1), chunk.begin(),
+                    chunk.end());
+        break;
+      }
+      default: // 与另一个语料交叉
+        if (!other.empty()) {
+          const size_t cut = pick(data.size() + 1);
+          const size_t from = pick(other.size());
+          data.resize(cut);
+          data.insert(data.end(), other.begin() + from, other.end());
+          if (data.size() > max_length)
+            data.resize(max_length);
+        }
+      }
+    }
+  }
+
+private:
+  size_t pick(size_t n) { return n ? _rng() % n : 0; }
+  std::mt19937_64 _rng;
+};
+
+// 模糊测试基类：fuzzOne 返回 z_failed、抛出异常或触发致命信号都视为崩溃，
+// 崩溃输入保存到 crashes 目录，之后每次运行都会作为回归用例回放。
+class ZFuzzTest : public ZTestBase {
+public:
+  explicit ZFuzzTest(const string &name) : ZTestBase(name, ZType::z_unsafe, "") {}
+
+  static ZFuzzOptions &options() {
+    static ZFuzzOptions opts;
+    return opts;
+  }
+
+  virtual ZState fuzzOne(const uint8_t *data, size_t size) = 0;
+  // 语料和变异是随机的，每次运行都要重新执行
+  bool cacheable() const override { return false; }
+
+  ZState run() override {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::path(options().root) / getName();
+    _corpus_dir = (dir / "corpus").string();
+    _crash_dir = (dir / "crashes").string();
+    // 回归：先回放已保存的崩溃和语料
+    for (const auto &path : listFiles(_crash_dir))
+      replay(path);
+    size_t replayed = 0;
+    for (const auto &path : listFiles(_corpus_dir)) {
+      replay(path);
+      ++replayed;
+    }
+    if (options().seconds <= 0)
+      return ZState::z_success;
+    logger.info("[Fuzz] " + getName() + ": replayed " +
+                std::to_string(replayed) + " corpus inputs, fuzzing for " +
+                std::to_string(options().seconds) + "s");
+    return fuzz();
+  }
+
+private:
+  struct Crash {
+    std::string path;
+    std::string reason;
+  };
+
+  static std::vector<std::string> listFiles(const std::string &dir) {
+    std::vector<std::string> out;
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
+      if (entry.is_regular_file())
+        out.push_back(entry.path().string());
+    std::sort(out.begin(), out.end());
+    return out;
+  }
+
+  static std::vector<uint8_t> readFile(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>()};
+  }
+  /**
+   * @description: 执行一次目标函数
+   * @return 失败原因，成功时为空
+   */
+  std::string execute(const std::vector<uint8_t> &input) {
+    try {
+      if (fuzzOne(input.data(), input.size()) != ZState::z_success)
+        return "fuzz target returned failure";
+      return "";
+    } catch (const std::exception &e) {
+      return e.what();
+    } catch (...) {
+      return "unknown exception";
+    }
+  }
+
+  void replay(const std::string &path) {
+    std::string reason = execute(readFile(path));
+    if (!reason.empty())
+      throw ZTestFailureException(getName(), "no failure on " + path,
+                                  reason);
+  }
+
+  static std::string save(const std::string &dir, const std::string &prefix,
+                          const std::vector<uint8_t> &input) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    const std::string path =
+        dir + "/" + prefix +
+        hashToHex(fnv1a64(input.data(), input.size()));
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(input.data()), input.size());
+    return path;
+  }
+
+  // 致命信号处理：把正在执行的输入写入崩溃目录后按默认方式结束进程
+  static inline char _signal_dir[4096];
+  static inline thread_local const std::vector<uint8_t> *_current = nullptr;
+
+  static void onSignal(int sig) {
+    if (const auto *input = _current) {
+      uint64_t hash = 0xcbf29ce484222325ULL;
+      for (uint8_t c : *input)
+        hash = (hash ^ c) * 0x100000001b3ULL;
+      char path[sizeof(_signal_dir) + 32];
+      size_t len = strnlen(_signal_dir, sizeof(_signal_dir));
+      std::memcpy(path, _signal_dir, len);
+      std::memcpy(path + len, "/crash-", 7);
+      len += 7;
+      for (int shift = 60; shift >= 0; shift -= 4)
+        path[len++] = "0123456789abcdef"[(hash >> shift) & 0xf];
+      path[len] = '\0';
+      int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd >= 0) {
+        ssize_t ignored = ::write(fd, input->data(), input->size());
+        (void)ignored;
+        ::close(fd);
+      }
+      static const char msg[] = "[Fuzz] fatal signal, input saved to ";
+      ssize_t ignored = ::write(STDERR_FILENO, msg, sizeof(msg) - 1);
+      ignored = ::write(STDERR_FILENO, path, len);
+      ignored = ::write(STDERR_FILENO, "\n", 1);
+      (void)ignored;
+    }
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+  }
+
+  ZState fuzz() {
+    const auto &opts = options();
+    const size_t workers =
+        opts.workers ? opts.workers
+                     : std::max(1u, std::thread::hardware_concurrency());
+    std::error_code ec;
+    std::filesystem::create_directories(_crash_dir, ec);
+    std::snprintf(_signal_dir, sizeof(_signal_dir), "%s", _crash_dir.c_str());
+    for (int sig : {SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS})
+      std::signal(sig, &ZFuzzTest::onSignal);
+
+    std::vector<std::vector<uint8_t>> corpus;
+    for (const auto &path : listFiles(_corpus_dir))
+      corpus.push_back(readFile(path));
+    if (corpus.empty())
+      corpus.push_back({});
+
+    std::mutex corpus_mutex;
+    std::vector<std::atomic<uint8_t>> virgin(kCoverageMapSize);
+    std::atomic<size_t> coverage{0};
+    std::atomic<uint64_t> execs{0};
+    std::atomic<bool> stop{false};
+    std::optional<Crash> crash;
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline =
+        start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(opts.seconds));
+    const uint64_t seed = std::random_device{}();
+
+    ZThreadPool pool(workers);
+    std::vector<std::future<void>> futures;
+    for (size_t w = 0; w < workers; ++w) {
+      futures.push_back(pool.enqueue([&, w] {
+        std::vector<uint8_t> map(kCoverageMapSize);
+        ztest_coverage_map = map.data();
+        ZMutator mutator(seed + w);
+        std::mt19937_64 rng(seed ^ (w * 0x9e3779b97f4a7c15ULL));
+        std::vector<uint8_t> input, other;
+        while (!stop.load(std::memory_order_relaxed)) {
+          {
+            std::lock_guard<std::mutex> lock(corpus_mutex);
+            input = corpus[rng() % corpus.size()];
+            other = corpus[rng() % corpus.size()];
+          }
+          mutator.mutate(input, opts.max_length, other);
+          std::memset(map.data(), 0, map.size());
+          _current = &input;
+          std::string reason = execute(input);
+          _current = nullptr;
+          execs.fetch_add(1, std::memory_order_relaxed);
+          if (!reason.empty()) {
+            std::lock_guard<std::mutex> lock(corpus_mutex);
+            if (!crash)
+              crash = Crash{save(_crash_dir, "crash-", input), reason};
+            stop = true;
+            break;
+          }
+          if (mergeCoverage(map, virgin, coverage)) {
+            std::lock_guard<std::mutex> lock(corpus_mutex);
+            corpus.push_back(input);
+            save(_corpus_dir, "", input);
+          }
+          // 每个工作线程每次执行后自行检查截止时间；每次执行都要清零并合并
+          // 64KB 的覆盖率表，读时钟的开销可以忽略
+          if (std::chrono::steady_clock::now() >= deadline)
+            stop = true;
+        }
+        ztest_coverage_map = nullptr;
+      }));
+    }
+
+    // 调用线程定期发布统计
+    ZFuzzStats stats;
+    stats.target = getName();
+    stats.active = true;
+    auto publish = [&] {
+      const double elapsed = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+      stats.execs = execs.load();
+      stats.execs_per_sec = elapsed > 0 ? stats.execs / elapsed : 0.0;
+      stats.coverage = coverage.load();
+      {
+        std::lock_guard<std::mutex> lock(corpus_mutex);
+        stats.corpus = corpus.size();
+        stats.crashes = crash ? 1 : 0;
+      }
+      ZFuzzMonitor::instance().update(stats);
+    };
+    for (auto &f : futures) {
+      while (f.wait_for(std::chrono::milliseconds(200)) !=
+             std::future_status::ready)
+        publish();
+      f.get();
+    }
+    publish();
+    stats.active = false;
+    ZFuzzMonitor::instance().update(stats);
+    for (int sig : {SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS})
+      std::signal(sig, SIG_DFL);
+
+    if (ztest_coverage_guards.load() == 0 && stats.coverage == 0)
+      logger.warning("[Fuzz] " + getName() +
+                     ": no coverage feedback, build with "
+                     "-fsanitize-coverage=trace-pc(-guard)");
+    logger.info("[Fuzz] " + getName() + ": " + std::to_string(stats.execs) +
+                " execs (" + std::to_string(static_cast<long>(
+                                 stats.execs_per_sec)) +
+                "/s), coverage " + std::to_string(stats.coverage) +
+                ", corpus " + std::to_string(stats.corpus));
+    if (crash)
+      throw ZTestFailureException(getName(), "no failure while fuzzing",
+                                  crash->reason + " (input saved to " +
+                                      crash->path + ")");
+    return ZState::z_success;
+  }
+  /**
+   * @description: 将本次执行的计数（按 AFL 的命中次数分桶）并入全局覆盖表
+   * @return 出现新的覆盖时为true
+   */
+  static bool mergeCoverage(const std::vector<uint8_t> &map,
+                            std::vector<std::atomic<uint8_t>> &virgin,
+                            std::atomic<size_t> &coverage) {
+    bool found = false;
+    const auto *words = reinterpret_cast<const uint64_t *>(map.data());
+    for (size_t w = 0; w < kCoverageMapSize / 8; ++w) {
+      if (words[w] == 0)
+        continue;
+      for (size_t i = w * 8; i < w * 8 + 8; ++i) {
+        if (!map[i])
+          continue;
+        const uint8_t bucket = bucketOf(map[i]);
+        const uint8_t seen =
+            virgin[i].fetch_or(bucket, std::memory_order_relaxed);
+        if ((seen & bucket) == 0) {
+          found = true;
+          if (seen == 0)
+            coverage.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    }
+    return found;
+  }
+
+  static uint8_t bucketOf(uint8_t hits) {
+    if (hits <= 3)
+      return uint8_t(1u << (hits - 1));
+    if (hits <= 7)
+      return 8;
+    if (hits <= 15)
+      return 16;
+    if (hits <= 31)
+      return 32;
+    if (hits <= 127)
+      return 64;
+    return 128;
+  }
+
+  std::string _corpus_dir;
+  std::string _crash_dir;
+};
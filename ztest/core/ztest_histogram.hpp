@@ -0,0 +1,97 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+// ZHdrHistogram 是对数-线性分桶的延迟直方图（HdrHistogram 的分桶方式）：
+// 每个2的幂区间分为128个子桶，相对误差不超过 1/128，记录范围 0..2^47 纳秒（约39小时），
+// 内存固定约 43KB，与记录的样本数无关。超出范围的值计入最高的桶。
+class ZHdrHistogram {
+public:
+  ZHdrHistogram() : _counts(kBucketCount, 0) {}
+  /**
+   * @description: 记录一个值
+   * @param value 值（纳秒）
+   * @param count 次数
+   */
+  void record(uint64_t value, uint64_t count = 1) {
+    _counts[indexOf(value)] += count;
+    _total += count;
+    _sum += static_cast<double>(value) * count;
+    if (_total == count || value < _min)
+      _min = value;
+    _max = std::max(_max, value);
+  }
+  void merge(const ZHdrHistogram &other) {
+    if (other._total == 0)
+      return;
+    for (size_t i = 0; i < kBucketCount; ++i)
+      _counts[i] += other._counts[i];
+    _min = _total == 0 ? other._min : std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+    _total += other._total;
+    _sum += other._sum;
+  }
+  void reset() {
+    std::fill(_counts.begin(), _counts.end(), 0);
+    _total = 0;
+    _sum = 0;
+    _min = _max = 0;
+  }
+  /**
+   * @description: 百分位数
+   * @param percentile 0~100
+   * @return 不小于该比例样本的值（所在桶的上界，不超过最大值）
+   */
+  uint64_t percentile(double percentile) const {
+    if (_total == 0)
+      return 0;
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const uint64_t target = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * _total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      seen += _counts[i];
+      if (seen >= target)
+        return std::clamp(upperBound(i), _min, _max);
+    }
+    return _max;
+  }
+  uint64_t count() const { return _total; }
+  uint64_t min() const { return _min; }
+  uint64_t max() const { return _max; }
+  double mean() const { return _total ? _sum / _total : 0.0; }
+  double sum() const { return _sum; }
+
+private:
+  static constexpr int kSubBits = 7;                  // 每个区间 2^7 个子桶
+  static constexpr uint64_t kLinear = 2u << kSubBits; // [0, 256) 逐值计数
+  static constexpr int kMaxBit = 47;
+  static constexpr size_t kBucketCount =
+      kLinear + (kMaxBit - kSubBits) * (1u << kSubBits);
+
+  static size_t indexOf(uint64_t value) {
+    if (value < kLinear)
+      return static_cast<size_t>(value);
+    const int msb = std::min(63 - __builtin_clzll(value), kMaxBit);
+    if (msb == kMaxBit && value >= (uint64_t(1) << (kMaxBit + 1)))
+      return kBucketCount - 1;
+    const int shift = msb - kSubBits;
+    const uint64_t sub = (value >> shift) - (uint64_t(1) << kSubBits);
+    return kLinear + (shift - 1) * (size_t(1) << kSubBits) + sub;
+  }
+  static uint64_t upperBound(size_t index) {
+    if (index < kLinear)
+      return index;
+    const size_t offset = index - kLinear;
+    const int shift = static_cast<int>(offset >> kSubBits) + 1;
+    const uint64_t sub = (offset & ((1u << kSubBits) - 1)) + (1u << kSubBits);
+    return ((sub + 1) << shift) - 1;
+  }
+
+  std::vector<uint64_t> _counts;
+  uint64_t _total = 0;
+  double _sum = 0;
+  uint64_t _min = 0;
+  uint64_t _max = 0;
+};
@@ -0,0 +1,191 @@
+#pragma once
+#include "ztest_affinity.hpp"
+#include "ztest_benchenv.hpp"
+#include "ztest_benchmark.hpp"
+#include "ztest_histogram.hpp"
+#include "ztest_logger.hpp"
+#include "ztest_result.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+// 开环负载测试：按目标速率的固定时间表发出请求，不等待上一个请求完成，
+// 每个请求的延迟从其计划发出的时刻算起。被测代码变慢时后续请求的排队时间也计入延迟，
+// 不会像闭环计时那样因少发请求而掩盖停顿（协调遗漏）。
+// 速率从 start_rate 起倍增，直到饱和或达到 max_rate；饱和前的最高速率即拐点。
+// 请求体（run_single_case）会在多个工作线程上并发调用，需要是线程安全的。
+struct ZLoadOptions {
+  double step_seconds = 1.0; // 每档速率的持续时间
+  size_t workers = 0;        // 发出请求的线程数，0 表示共享线程池的线程数
+  double growth = 2.0;       // 相邻两档速率之比
+  // 实际速率低于目标的该比例，或 p99 超过最低一档的该倍数时判为饱和
+  double min_achieved = 0.95;
+  double max_p99_growth = 10.0;
+};
+
+class ZLoadTest : public ZBenchMark {
+private:
+  double _start_rate;
+  double _max_rate;
+
+public:
+  ZLoadTest(const std::string &name, double start_rate, double max_rate,
+            const std::string &description = "")
+      : ZBenchMark(name, description), _start_rate(std::max(start_rate, 1.0)),
+        _max_rate(std::max(max_rate, start_rate)) {}
+
+  static ZLoadOptions &options() {
+    static ZLoadOptions opts;
+    return opts;
+  }
+  std::unique_ptr<ZTestBase> clone() const override {
+    return std::make_unique<ZLoadTest>(*this);
+  }
+
+  /**
+   * @description: 扫描速率直到饱和，结果记入 _load
+   */
+  ZState run() override {
+    const ZLoadOptions opts = options();
+    const size_t workers =
+        opts.workers > 0 ? opts.workers : ZAffinity::workerCount();
+    ZBenchProbe probe;
+    probe.begin(getName());
+    ZTimer timer;
+    timer.start();
+
+    ZLoadSummary summary;
+    ZHdrHistogram all;
+    for (double rate = _start_rate;; rate *= std::max(opts.growth, 1.01)) {
+      rate = std::min(rate, _max_rate);
+      ZHdrHistogram histogram;
+      ZLoadPoint point = runStep(rate, workers, opts.step_seconds, histogram);
+      all.merge(histogram);
+      const ZLoadPoint *first = summary.points.empty() ? &point
+                                                       : &summary.points.front();
+      if (point.achieved_rate < opts.min_achieved * rate) {
+        point.saturated = true;
+        summary.saturation = "achieved " + format(point.achieved_rate) +
+                             "/s of " + format(rate) + "/s";
+      } else if (point.p99_ns > opts.max_p99_growth * first->p99_ns &&
+                 first != &point) {
+        point.saturated = true;
+        summary.saturation = "p99 " + format(point.p99_ns / 1e3) + "us vs " +
+                             format(first->p99_ns / 1e3) + "us at " +
+                             format(first->target_rate) + "/s";
+      }
+      logger.info("[Load] " + getName() + " " + format(rate) + "/s: achieved " +
+                  format(point.achieved_rate) + "/s, p50 " +
+                  format(point.p50_ns / 1e3) + "us, p99 " +
+                  format(point.p99_ns / 1e3) + "us" +
+                  (point.saturated ? " (saturated)" : ""));
+      if (!point.saturated)
+        summary.knee_rate = rate;
+      summary.points.push_back(point);
+      if (point.saturated || rate >= _max_rate)
+        break;
+    }
+    timer.stop();
+    _environment = probe.end(timer.getElapsedMilliseconds());
+
+    _iterationTimestamps.clear();
+    _counters.clear();
+    // 请求在多个线程上重叠执行，延迟之和不是耗时；计时部分取整个速率扫描的墙钟时间，
+    // 平均延迟另记在汇总中
+    _completed = all.count();
+    _measured_ms = timer.getElapsedMilliseconds();
+    summary.mean_ns = all.mean();
+    _load = std::move(summary);
+    setState(ZState::z_success);
+    return ZState::z_success;
+  }
+
+private:
+  /**
+   * @description: 以固定速率运行一档：第 k 个请求计划在 start + k/rate 发出，
+   *               由第 k % workers 个线程负责
+   */
+  ZLoadPoint runStep(double rate, size_t workers, double seconds,
+                     ZHdrHistogram &merged) {
+    using clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration<double>(1.0 / rate);
+    const uint64_t total = std::max<uint64_t>(
+        1, static_cast<uint64_t>(rate * seconds));
+    workers = std::max<size_t>(1, std::min<uint64_t>(workers, total));
+
+    std::vector<ZHdrHistogram> histograms(workers);
+    std::vector<std::exception_ptr> errors(workers);
+    std::atomic<bool> failed{false};
+    ZSpinBarrier barrier(workers + 1);
+    clock::time_point start;
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (size_t w = 0; w < workers; ++w) {
+      threads.emplace_back([&, w] {
+        ZAffinity::applyWorker(w);
+        barrier.arriveAndWait();
+        try {
+          for (uint64_t k = w; k < total && !failed; k += workers) {
+            const auto intended =
+                start + std::chrono::duration_cast<clock::duration>(interval * k);
+            waitUntil(intended);
+            run_single_case();
+            const auto latency = clock::now() - intended;
+            // 从计划时刻计时，迟发请求的等待已包含在内，无需再补记样本
+            histograms[w].record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(latency)
+                    .count()));
+          }
+        } catch (...) {
+          errors[w] = std::current_exception();
+          failed = true;
+        }
+      });
+    }
+    // 起点略晚于放行，避免第一批请求因线程启动而迟发
+    start = clock::now() + std::chrono::milliseconds(1);
+    barrier.arriveAndWait();
+    for (auto &thread : threads)
+      thread.join();
+    const double elapsed =
+        std::chrono::duration<double>(clock::now() - start).count();
+    for (auto &error : errors)
+      if (error)
+        std::rethrow_exception(error);
+
+    for (const auto &histogram : histograms)
+      merged.merge(histogram);
+    ZLoadPoint point;
+    point.target_rate = rate;
+    point.requests = total;
+    point.achieved_rate = elapsed > 0 ? total / elapsed : 0.0;
+    point.mean_ns = merged.mean();
+    point.p50_ns = merged.percentile(50);
+    point.p90_ns = merged.percentile(90);
+    point.p99_ns = merged.percentile(99);
+    point.p999_ns = merged.percentile(99.9);
+    point.max_ns = merged.max();
+    return point;
+  }
+  /**
+   * @description: 等到计划时刻；较远时先睡眠，最后100微秒自旋以减小误差
+   */
+  static void waitUntil(std::chrono::steady_clock::time_point when) {
+    using namespace std::chrono;
+    if (when - steady_clock::now() > microseconds(200))
+      std::this_thread::sleep_until(when - microseconds(100));
+    while (steady_clock::now() < when) {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    }
+  }
+  static std::string format(double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f", value);
+    return buf;
+  }
+};
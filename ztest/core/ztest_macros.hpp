@@ -1,49 +1,158 @@
 #pragma once
+#include "ztest_assert.hpp"
+#include "ztest_compare.hpp"
+#include "ztest_snapshot.hpp"
 #include <cmath>
-#define EXPECT_EQ(expected, actual)                                            \
+// 断言宏只在失败时调用 ZAssertBuffer::fail，通过路径上没有格式化和内存分配。
+// EXPECT_* 失败后记录并继续执行；ASSERT_* 失败后抛出异常终止测试，
+// 因此两者都可用于测试体、辅助函数和任意返回类型的 lambda。
+#define ZTEST_ASSERT_FAIL_(op, fatal, ...)                                     \
+  ZAssertBuffer::current().fail(op, fatal, __FILE__, __LINE__, __VA_ARGS__)
+#define ZTEST_ASSERT_CMP_(op, cond, a, b, fatal)                               \
   do {                                                                         \
-    auto &&_z_expected = (expected);                                           \
-    auto &&_z_actual = (actual);                                               \
-    if (_z_expected != _z_actual) {                                            \
-      std::ostringstream _z_ess;                                               \
-      _z_ess << _z_expected;                                                   \
-      std::ostringstream _z_ass;                                               \
-      _z_ass << _z_actual;                                                     \
-      throw ZTestFailureException(this->getName(), _z_ess.str(),               \
-                                  _z_ass.str());                               \
-    }                                                                          \
+    auto &&_z_lhs = (a);                                                       \
+    auto &&_z_rhs = (b);                                                       \
+    if (!(cond))                                                               \
+      ZTEST_ASSERT_FAIL_(op, fatal, #a, #b, _z_lhs, _z_rhs);                   \
   } while (0)
-#define EXPECT_NEAR(expected, actual, epsilon)                                 \
+#define ZTEST_ASSERT_NEAR_(expected, actual, epsilon, fatal)                   \
+  do {                                                                         \
+    auto &&_z_lhs = (expected);                                                \
+    auto &&_z_rhs = (actual);                                                  \
+    auto &&_z_eps = (epsilon);                                                 \
+    if (!(std::abs(_z_lhs - _z_rhs) <= _z_eps))                                \
+      ZTEST_ASSERT_FAIL_(ZAssertOp::z_near, fatal, #expected,                  \
+                         #actual ", " #epsilon, _z_lhs, _z_rhs, _z_eps);       \
+  } while (0)
+#define ZTEST_ASSERT_STREQ_(expected, actual, fatal)                           \
+  do {                                                                         \
+    auto &&_z_l = (expected);                                                  \
+    auto &&_z_r = (actual);                                                    \
+    const std::string_view _z_lhs = _z_l;                                      \
+    const std::string_view _z_rhs = _z_r;                                      \
+    if (_z_lhs != _z_rhs)                                                      \
+      ZTEST_ASSERT_FAIL_(ZAssertOp::z_streq, fatal, #expected, #actual,        \
+                         _z_lhs, _z_rhs);                                      \
+  } while (0)
+#define ZTEST_ASSERT_BOOL_(cond, value, fatal)                                 \
   do {                                                                         \
-    auto &&_z_expected = (expected);                                           \
-    auto &&_z_actual = (actual);                                               \
-    auto &&_z_epsilon = (epsilon);                                             \
-    if (std::abs(_z_expected - _z_actual) > _z_epsilon) {                      \
-      std::ostringstream _z_ess;                                               \
-      _z_ess << _z_expected;                                                   \
-      std::ostringstream _z_ass;                                               \
-      _z_ass << _z_actual;                                                     \
-      std::ostringstream _z_eps;                                               \
-      _z_eps << _z_epsilon;                                                    \
-      std::ostringstream _z_diff;                                              \
-      _z_diff << std::abs(_z_expected - _z_actual);                            \
-      throw ZTestFailureException(                                             \
-          this->getName(),                                                     \
-          ("Expected value near " + _z_ess.str() + " ± " + _z_eps.str())       \
-              .c_str(),                                                        \
-          ("Actual value was " + _z_ass.str() + " (diff = " + _z_diff.str() +  \
-           ")")                                                                \
-              .c_str());                                                       \
+    if (static_cast<bool>(cond) != value)                                      \
+      ZTEST_ASSERT_FAIL_(value ? ZAssertOp::z_true : ZAssertOp::z_false,       \
+                         fatal, #cond, "", value, !value);                     \
+  } while (0)
+#define ZTEST_ASSERT_ARRAY_(op, compare, lhs_expr, rhs_expr, fatal)           \
+  do {                                                                         \
+    const ZCompareReport _z_report = compare;                                  \
+    if (!_z_report.ok())                                                       \
+      ZTEST_ASSERT_FAIL_(op, fatal, lhs_expr, rhs_expr,                        \
+                         std::string_view(_z_report.expected),                 \
+                         std::string_view(_z_report.actual));                  \
+  } while (0)
+#define ZTEST_ASSERT_THROW_(statement, exception, fatal)                       \
+  do {                                                                         \
+    const char *_z_outcome = "nothing was thrown";                             \
+    try {                                                                      \
+      statement;                                                               \
+    } catch (const exception &) {                                              \
+      _z_outcome = nullptr;                                                    \
+    } catch (...) {                                                            \
+      _z_outcome = "a different exception was thrown";                         \
     }                                                                          \
+    if (_z_outcome)                                                            \
+      ZTEST_ASSERT_FAIL_(ZAssertOp::z_throw, fatal, #statement, #exception,    \
+                         _z_outcome, 0);                                       \
   } while (0)
-#define ASSERT_TRUE(cond)                                                      \
+#define ZTEST_ASSERT_NO_THROW_(statement, fatal)                               \
   do {                                                                         \
-    if (!(cond)) {                                                             \
-      std::ostringstream _z_oss;                                               \
-      _z_oss << "false ( " << #cond << " )";                                   \
-      throw ZTestFailureException(this->getName(), "true", _z_oss.str());      \
+    const char *_z_outcome = nullptr;                                          \
+    try {                                                                      \
+      statement;                                                               \
+    } catch (const std::exception &) {                                         \
+      _z_outcome = "std::exception";                                           \
+    } catch (...) {                                                            \
+      _z_outcome = "an unknown exception";                                     \
     }                                                                          \
+    if (_z_outcome)                                                            \
+      ZTEST_ASSERT_FAIL_(ZAssertOp::z_no_throw, fatal, #statement, "",         \
+                         _z_outcome, 0);                                       \
   } while (0)
+
+#define EXPECT_EQ(expected, actual)                                            \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_eq, _z_lhs == _z_rhs, expected, actual, false)
+#define EXPECT_NE(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_ne, _z_lhs != _z_rhs, a, b, false)
+#define EXPECT_LT(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_lt, _z_lhs < _z_rhs, a, b, false)
+#define EXPECT_LE(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_le, _z_lhs <= _z_rhs, a, b, false)
+#define EXPECT_GT(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_gt, _z_lhs > _z_rhs, a, b, false)
+#define EXPECT_GE(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_ge, _z_lhs >= _z_rhs, a, b, false)
+#define EXPECT_NEAR(expected, actual, epsilon)                                 \
+  ZTEST_ASSERT_NEAR_(expected, actual, epsilon, false)
+#define EXPECT_STREQ(expected, actual)                                         \
+  ZTEST_ASSERT_STREQ_(expected, actual, false)
+#define EXPECT_TRUE(cond) ZTEST_ASSERT_BOOL_(cond, true, false)
+#define EXPECT_FALSE(cond) ZTEST_ASSERT_BOOL_(cond, false, false)
+#define EXPECT_THROW(statement, exception)                                     \
+  ZTEST_ASSERT_THROW_(statement, exception, false)
+#define EXPECT_NO_THROW(statement) ZTEST_ASSERT_NO_THROW_(statement, false)
+// 批量比较连续序列（vector、array、span等），失败时报告不匹配数量、
+// 最大误差及其下标；tolerance 可以是数值（绝对容差）或 ZTolerance
+#define EXPECT_ARRAY_EQ(expected, actual)                                      \
+  ZTEST_ASSERT_ARRAY_(ZAssertOp::z_array_eq,                                   \
+                      ZArrayCompare::equal(expected, actual), #expected,       \
+                      #actual, false)
+#define EXPECT_ARRAY_NEAR(expected, actual, tolerance)                         \
+  ZTEST_ASSERT_ARRAY_(ZAssertOp::z_array_near,                                 \
+                      ZArrayCompare::near(expected, actual, tolerance),        \
+                      #expected, #actual ", " #tolerance, false)
+#define EXPECT_BYTES_EQ(expected, actual)                                      \
+  ZTEST_ASSERT_ARRAY_(ZAssertOp::z_bytes_eq,                                   \
+                      ZArrayCompare::bytes(expected, actual), #expected,       \
+                      #actual, false)
+
+#define ASSERT_EQ(expected, actual)                                            \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_eq, _z_lhs == _z_rhs, expected, actual, true)
+#define ASSERT_NE(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_ne, _z_lhs != _z_rhs, a, b, true)
+#define ASSERT_LT(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_lt, _z_lhs < _z_rhs, a, b, true)
+#define ASSERT_LE(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_le, _z_lhs <= _z_rhs, a, b, true)
+#define ASSERT_GT(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_gt, _z_lhs > _z_rhs, a, b, true)
+#define ASSERT_GE(a, b)                                                        \
+  ZTEST_ASSERT_CMP_(ZAssertOp::z_ge, _z_lhs >= _z_rhs, a, b, true)
+#define ASSERT_NEAR(expected, actual, epsilon)                                 \
+  ZTEST_ASSERT_NEAR_(expected, actual, epsilon, true)
+#define ASSERT_STREQ(expected, actual)                                         \
+  ZTEST_ASSERT_STREQ_(expected, actual, true)
+#define ASSERT_TRUE(cond) ZTEST_ASSERT_BOOL_(cond, true, true)
+#define ASSERT_FALSE(cond) ZTEST_ASSERT_BOOL_(cond, false, true)
+#define ASSERT_THROW(statement, exception)                                     \
+  ZTEST_ASSERT_THROW_(statement, exception, true)
+#define ASSERT_NO_THROW(statement) ZTEST_ASSERT_NO_THROW_(statement, true)
+// 与快照文件比较，name 相对于快照目录（默认 snapshots/），.gz 结尾时压缩存储
+#define EXPECT_SNAPSHOT(name, actual)                                          \
+  ZTEST_ASSERT_ARRAY_(ZAssertOp::z_snapshot, ZSnapshot::compare(name, actual), \
+                      #name, #actual, false)
+#define ASSERT_SNAPSHOT(name, actual)                                          \
+  ZTEST_ASSERT_ARRAY_(ZAssertOp::z_snapshot, ZSnapshot::compare(name, actual), \
+                      #name, #actual, true)
+#define ASSERT_ARRAY_EQ(expected, actual)                                      \
+  ZTEST_ASSERT_ARRAY_(ZAssertOp::z_array_eq,                                   \
+                      ZArrayCompare::equal(expected, actual), #expected,       \
+                      #actual, true)
+#define ASSERT_ARRAY_NEAR(expected, actual, tolerance)                         \
+  ZTEST_ASSERT_ARRAY_(ZAssertOp::z_array_near,                                 \
+                      ZArrayCompare::near(expected, actual, tolerance),        \
+                      #expected, #actual ", " #tolerance, true)
+#define ASSERT_BYTES_EQ(expected, actual)                                      \
+  ZTEST_ASSERT_ARRAY_(ZAssertOp::z_bytes_eq,                                   \
+                      ZArrayCompare::bytes(expected, actual), #expected,       \
+                      #actual, true)
 // TODO: 修正HOOKS运行的位置
 #define BEFOREALL(func) addBeforeAll([this]() { func; })
 #define AFTEREACH(func) addAfterEach([this]() { func; })
@@ -75,6 +184,99 @@
   }                                                                            \
   ZState suite_name##_##test_name::run()
 
+// 调度声明：依赖的测试通过后才运行，运行期间占用命名锁或信号量。
+// unsafe、基准和参数化测试按类型分阶段串行运行（unsafe、safe、基准、参数化），
+// 它们的依赖须是更早阶段或同一阶段中排在前面的测试。例如
+// ZTEST_DEPENDS_ON(DB, Query, "DB.Schema", "DB.Load");
+// ZTEST_LOCK(DB, Load, "database");
+// ZTEST_SEMAPHORE(DB, Query, "connections", 4);
+#define ZTEST_CONCAT_INNER_(a, b) a##b
+#define ZTEST_CONCAT_(a, b) ZTEST_CONCAT_INNER_(a, b)
+#define ZTEST_CONFIGURE_(suite, test, ...)                                     \
+  namespace {                                                                  \
+  struct ZTEST_CONCAT_(suite##_##test##_config_, __LINE__) {                   \
+    ZTEST_CONCAT_(suite##_##test##_config_, __LINE__)() {                      \
+      ZTestRegistry::instance().configure(                                     \
+          #suite "." #test, [](ZTestBase &_z_test) { __VA_ARGS__; });          \
+    }                                                                          \
+  } ZTEST_CONCAT_(suite##_##test##_config_instance_, __LINE__);                \
+  }
+#define ZTEST_DEPENDS_ON(suite, test, ...)                                     \
+  ZTEST_CONFIGURE_(suite, test, for (const char *_z_dep : {__VA_ARGS__})       \
+                                    _z_test.dependsOn(_z_dep))
+#define ZTEST_LOCK(suite, test, name)                                          \
+  ZTEST_CONFIGURE_(suite, test, _z_test.withLock(name))
+#define ZTEST_SEMAPHORE(suite, test, name, capacity)                           \
+  ZTEST_CONFIGURE_(suite, test, _z_test.withSemaphore(name, capacity))
+
+// 共享夹具：scope 为 run、suite 或 thread，函数体返回 shared_ptr<type>，
+// 测试中以 ZFixture::get<type>("name") 取得只读对象。例如
+// ZFIXTURE(BigIndex, Index, run) { return make_shared<Index>(load()); }
+// ZTEST_USES_FIXTURE(Search, Lookup, "BigIndex");
+#define ZFIXTURE(name, type, scope)                                            \
+  static shared_ptr<type> name##_fixture_build();                              \
+  namespace {                                                                  \
+  struct name##_fixture_registrar {                                            \
+    name##_fixture_registrar() {                                               \
+      ZFixture::define<type>(#name, ZFixtureScope::z_##scope,                  \
+                             &name##_fixture_build);                           \
+    }                                                                          \
+  } name##_fixture_instance;                                                   \
+  }                                                                            \
+  static shared_ptr<type> name##_fixture_build()
+#define ZTEST_USES_FIXTURE(suite, test, ...)                                   \
+  ZTEST_CONFIGURE_(suite, test, for (const char *_z_fixture : {__VA_ARGS__})   \
+                                    _z_test.useFixture(_z_fixture))
+
+// 性质测试：params 为性质函数的参数列表，其后依次为每个参数的生成器，
+// 性质函数体返回 bool，返回 false 或抛出异常表示不成立。例如
+// ZTEST_PROPERTY(Math, AddCommutes, (int a, int b), ZGen::integer<int>(),
+//                ZGen::integer<int>()) { return add(a, b) == add(b, a); }
+#define ZTEST_PROPERTY(suite, test, params, ...)                               \
+  class suite##_##test : public ZPropertyTest {                                \
+  public:                                                                      \
+    suite##_##test() : ZPropertyTest(#suite "." #test, ZType::z_safe, "") {}   \
+    unique_ptr<ZTestBase> clone() const override {                             \
+      return make_unique<suite##_##test>(*this);                               \
+    }                                                                          \
+    ZState run() override {                                                    \
+      return checkProperty(&suite##_##test::property,                          \
+                           ZPropertyRunner::defaultConfig(), __VA_ARGS__);     \
+    }                                                                          \
+    static bool property params;                                               \
+    static void _register() {                                                  \
+      ZTestRegistry::instance().addTest(make_unique<suite##_##test>());        \
+    }                                                                          \
+  };                                                                           \
+  namespace {                                                                  \
+  struct suite##_##test##_registrar {                                          \
+    suite##_##test##_registrar() { suite##_##test::_register(); }              \
+  } suite##_##test##_instance;                                                 \
+  }                                                                            \
+  bool suite##_##test::property params
+
+// 模糊测试：函数体通过 data/size 读取输入，返回 z_failed、断言失败或抛出异常
+// 都视为崩溃。例如
+// ZFUZZ(Parser, ParseCsv) { parseCsv(data, size); return ZState::z_success; }
+#define ZFUZZ(suite, test)                                                     \
+  class suite##_##test : public ZFuzzTest {                                    \
+  public:                                                                      \
+    suite##_##test() : ZFuzzTest(#suite "." #test) {}                          \
+    unique_ptr<ZTestBase> clone() const override {                             \
+      return make_unique<suite##_##test>(*this);                               \
+    }                                                                          \
+    ZState fuzzOne(const uint8_t *data, size_t size) override;                 \
+    static void _register() {                                                  \
+      ZTestRegistry::instance().addTest(make_unique<suite##_##test>());        \
+    }                                                                          \
+  };                                                                           \
+  namespace {                                                                  \
+  struct suite##_##test##_registrar {                                          \
+    suite##_##test##_registrar() { suite##_##test::_register(); }              \
+  } suite##_##test##_instance;                                                 \
+  }                                                                            \
+  ZState suite##_##test::fuzzOne(const uint8_t *data, size_t size)
+
 #define ZBENCHMARK(...)                                                        \
   ZBENCHMARK_IMPL(__VA_ARGS__, ZBENCHMARK3, ZBENCHMARK2)(__VA_ARGS__)
 #define ZBENCHMARK_IMPL(_1, _2, _3, NAME, ...) NAME
@@ -105,6 +307,102 @@
       used)) suite_name##_##test_name##_Benchmark_registrar_instance;          \
   }                                                                            \
   ZState suite_name##_##test_name##_Benchmark::run_single_case()
+// 基准测试的准备和清理，不计入迭代时间。例如
+// ZBENCHMARK_SETUP(Vector, Sort) { input = shuffled(10000); }
+// ZBENCHMARK_BATCH_SETUP(Vector, Sort, 100) { ... } 每100次迭代调用一次
+#define ZBENCHMARK_HOOK_(suite, test, hook, ...)                               \
+  static void suite##_##test##_##hook();                                       \
+  ZTEST_CONFIGURE_(suite, test,                                                \
+                   dynamic_cast<ZBenchMark &>(_z_test).hook(                   \
+                       &suite##_##test##_##hook __VA_ARGS__))                  \
+  static void suite##_##test##_##hook()
+#define ZBENCHMARK_SETUP(suite, test) ZBENCHMARK_HOOK_(suite, test, withSetUp)
+#define ZBENCHMARK_TEARDOWN(suite, test)                                       \
+  ZBENCHMARK_HOOK_(suite, test, withTearDown)
+#define ZBENCHMARK_BATCH_SETUP(suite, test, batch_size)                        \
+  ZBENCHMARK_HOOK_(suite, test, withBatchSetUp, , batch_size)
+#define ZBENCHMARK_BATCH_TEARDOWN(suite, test)                                 \
+  ZBENCHMARK_HOOK_(suite, test, withBatchTearDown)
+
+// 基准测试每次迭代处理的字节数/条目数，结果中汇总为每秒吞吐量。
+// 处理量不固定时在基准体中调用 addBytes/addItems，自定义计数器用 addCounter
+#define ZBENCHMARK_BYTES(suite, test, bytes)                                   \
+  ZTEST_CONFIGURE_(suite, test,                                                \
+                   dynamic_cast<ZBenchMark &>(_z_test).withBytesPerIteration(  \
+                       bytes))
+#define ZBENCHMARK_ITEMS(suite, test, items)                                   \
+  ZTEST_CONFIGURE_(suite, test,                                                \
+                   dynamic_cast<ZBenchMark &>(_z_test).withItemsPerIteration(  \
+                       items))
+
+// 浸泡测试：按时长运行基准测试，只保留固定大小的直方图和窗口序列
+#define ZBENCHMARK_SOAK(suite, test, seconds)                                  \
+  ZTEST_CONFIGURE_(suite, test,                                                \
+                   dynamic_cast<ZBenchMark &>(_z_test).withDuration(seconds))
+
+// 冷启动测试：每个样本在新进程中只运行一次基准体，测量首次调用、缺页和启动时间
+#define ZBENCHMARK_COLD_START(suite, test, samples)                            \
+  ZTEST_CONFIGURE_(suite, test,                                                \
+                   dynamic_cast<ZBenchMark &>(_z_test).withColdStart(samples))
+
+// 开环负载测试：从 start_rate 起倍增请求速率直到饱和或达到 max_rate，
+// 函数体为一次请求，会在多个线程上并发调用
+#define ZLOADTEST(suite_name, test_name, start_rate, max_rate)                 \
+  class suite_name##_##test_name##_LoadTest : public ZLoadTest {               \
+  public:                                                                      \
+    suite_name##_##test_name##_LoadTest()                                      \
+        : ZLoadTest(#suite_name "." #test_name, start_rate, max_rate) {}       \
+    ZState run_single_case() override;                                         \
+    std::unique_ptr<ZTestBase> clone() const override {                        \
+      return std::make_unique<suite_name##_##test_name##_LoadTest>(*this);     \
+    }                                                                          \
+  };                                                                           \
+  namespace {                                                                  \
+  struct suite_name##_##test_name##_LoadTest_registrar {                       \
+    suite_name##_##test_name##_LoadTest_registrar() {                          \
+      ZTestRegistry::instance().addTest(                                       \
+          std::make_unique<suite_name##_##test_name##_LoadTest>());            \
+    }                                                                          \
+  };                                                                           \
+  __attribute__((used)) suite_name##_##test_name##_LoadTest_registrar          \
+      suite_name##_##test_name##_LoadTest_registrar_instance;                  \
+  }                                                                            \
+  ZState suite_name##_##test_name##_LoadTest::run_single_case()
+
+// 多线程基准测试：在 1..max_threads 个线程上运行，基准体中可用
+// threadIndex()/threadCount()
+#define ZBENCHMARK_THREADS(...)                                                \
+  ZBENCHMARK_THREADS_IMPL(__VA_ARGS__, ZBENCHMARK_THREADS4,                    \
+                          ZBENCHMARK_THREADS3)(__VA_ARGS__)
+#define ZBENCHMARK_THREADS_IMPL(_1, _2, _3, _4, NAME, ...) NAME
+#define ZBENCHMARK_THREADS3(suite_name, test_name, max_threads)                \
+  ZBENCHMARK_THREADS4(suite_name, test_name, max_threads, 1000)
+#define ZBENCHMARK_THREADS4(suite_name, test_name, max_threads, iterations)    \
+  class suite_name##_##test_name##_Benchmark : public ZThreadedBenchMark {     \
+  public:                                                                      \
+    suite_name##_##test_name##_Benchmark()                                     \
+        : ZThreadedBenchMark(#suite_name "." #test_name, max_threads) {        \
+      withIterations(iterations);                                              \
+    }                                                                          \
+    ZState run_single_case() override;                                         \
+    std::unique_ptr<ZTestBase> clone() const override {                        \
+      return std::make_unique<suite_name##_##test_name##_Benchmark>(*this);    \
+    }                                                                          \
+    static void _register() {                                                  \
+      ZTestRegistry::instance().addTest(                                       \
+          std::make_unique<suite_name##_##test_name##_Benchmark>());           \
+    }                                                                          \
+  };                                                                           \
+  namespace {                                                                  \
+  struct suite_name##_##test_name##_Benchmark_registrar {                      \
+    suite_name##_##test_name##_Benchmark_registrar() {                         \
+      suite_name##_##test_name##_Benchmark::_register();                       \
+    }                                                                          \
+  };                                                                           \
+  __attribute__((used)) suite_name##_##test_name##_Benchmark_registrar         \
+      suite_name##_##test_name##_Benchmark_registrar_instance;                 \
+  }                                                                            \
+  ZState suite_name##_##test_name##_Benchmark::run_single_case()
 
 #define ZTEST_P(suite, test, data_manager)                                     \
   class suite##_##test                                                         \
@@ -139,13 +437,36 @@
   } while (0)
 #define ZTEST_P_CSV(suite, test, csv_file_path)                                \
   class suite##_##test                                                         \
-      : public ZTestParameterized<std::vector<CSVCell>, CSVCell> {             \
+      : public ZTestLazyParameterized<ZTestCSVDataManager> {                   \
+  public:                                                                      \
+    suite##_##test()                                                           \
+        : ZTestLazyParameterized(#suite "." #test, ZType::z_param, "",         \
+                                 csv_file_path) {}                             \
+    unique_ptr<ZTestBase> clone() const override {                             \
+      return make_unique<suite##_##test>(*this);                               \
+    }                                                                          \
+    ZState run_single_case() override;                                         \
+    static void _register() {                                                  \
+      ZTestRegistry::instance().addTest(make_unique<suite##_##test>());        \
+    }                                                                          \
+    std::vector<CSVCell> getInput() const {                                    \
+      return _dataset->current().first;                                        \
+    }                                                                          \
+    CSVCell getOutput() const { return _dataset->current().second; }           \
+  };                                                                           \
+  namespace {                                                                  \
+  struct suite##_##test##_registrar {                                          \
+    suite##_##test##_registrar() { suite##_##test::_register(); }              \
+  } suite##_##test##_instance;                                                 \
+  }                                                                            \
+  ZState suite##_##test::run_single_case()
+#define ZTEST_P_COLUMNAR(suite, test, zcol_file_path)                          \
+  class suite##_##test                                                         \
+      : public ZTestLazyParameterized<ZColumnarDataManager> {                  \
   public:                                                                      \
     suite##_##test()                                                           \
-        : ZTestParameterized(                                                  \
-              #suite "." #test, ZType::z_param, "",                            \
-              *ZDataRegistry::instance().load<ZTestCSVDataManager>(            \
-                  csv_file_path)) {}                                           \
+        : ZTestLazyParameterized(#suite "." #test, ZType::z_param, "",         \
+                                 zcol_file_path) {}                            \
     unique_ptr<ZTestBase> clone() const override {                             \
       return make_unique<suite##_##test>(*this);                               \
     }                                                                          \
@@ -153,12 +474,12 @@
     static void _register() {                                                  \
       ZTestRegistry::instance().addTest(make_unique<suite##_##test>());        \
     }                                                                          \
-    std::vector<CSVCell> getInput() const { return _data.current().first; }    \
-    CSVCell getOutput() const { return _data.current().second; }               \
-                                                                               \
-  private:                                                                     \
-    using Base = ZTestParameterized<std::vector<CSVCell>, CSVCell>;            \
-    using Base::_data;                                                         \
+    template <typename T> T getInput(size_t column) const {                    \
+      return _dataset->template get<T>(column);                                \
+    }                                                                          \
+    template <typename T> T getOutput() const {                                \
+      return _dataset->template get<T>(_dataset->columns() - 1);               \
+    }                                                                          \
   };                                                                           \
   namespace {                                                                  \
   struct suite##_##test##_registrar {                                          \
@@ -18,6 +18,11 @@ public:
    * @return 测试用例的数量
    */
   virtual size_t size() const = 0;
+  /**
+   * @description: 获取数据集占用的内存字节数，用于缓存的内存预算
+   * @return 字节数
+   */
+  virtual size_t memoryFootprint() const = 0;
 };
 template <typename InputType, typename OutputType> class ZTestDataManager {
 
@@ -68,6 +73,29 @@ public:
    * @return 测试用例的数量
    */
   size_t size() const override { return _total_cases; }
+  /**
+   * @description: 统计数据集的内存占用，包括行向量与堆上分配的字符串
+   * @return 字节数
+   */
+  size_t memoryFootprint() const override {
+    auto heapBytes = [](const CSVCell &cell) -> size_t {
+      const auto *str = std::get_if<std::string>(&cell);
+      if (!str)
+        return 0;
+      const char *data = str->data();
+      const char *self = reinterpret_cast<const char *>(str);
+      bool is_local = data >= self && data < self + sizeof(std::string);
+      return is_local ? 0 : str->capacity() + 1;
+    };
+    size_t bytes = sizeof(*this) + _filename.capacity() +
+                   _data.capacity() * sizeof(_data[0]);
+    for (const auto &[inputs, output] : _data) {
+      bytes += inputs.capacity() * sizeof(CSVCell) + heapBytes(output);
+      for (const auto &cell : inputs)
+        bytes += heapBytes(cell);
+    }
+    return bytes;
+  }
   ZTestCSVDataManager(const string &filename)
       : ZTestDataManager({}), _filename(filename) {
     logger.debug("Initializing CSV data manager for: " + filename);
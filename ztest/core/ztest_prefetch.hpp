@@ -0,0 +1,96 @@
+#pragma once
+#include "ztest_base.hpp"
+#include "ztest_dataregistry.hpp"
+#include "ztest_thread.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+// ZDataPrefetcher 在后台线程中提前加载即将运行的参数化测试的数据集，
+// 加载结果进入 ZDataRegistry 缓存，测试绑定数据时直接命中或等待同一次加载。
+class ZDataPrefetcher {
+public:
+  static ZDataPrefetcher &instance() {
+    static ZDataPrefetcher prefetcher;
+    return prefetcher;
+  }
+  /**
+   * @description: 设置调度器向前预取的测试数量
+   * @param depth 预取深度，等于0时关闭预取
+   */
+  void setDepth(size_t depth) { _depth = depth; }
+  size_t getDepth() const { return _depth; }
+  /**
+   * @description: 在后台线程中加载数据集
+   * @tparam T 数据管理器类型
+   * @param filePath 数据文件路径
+   */
+  template <typename T> void prefetch(const std::string &filePath) {
+    if (_depth == 0)
+      return;
+    logger.debug("Prefetching dataset: " + filePath);
+    pool().enqueue([filePath] {
+      try {
+        ZDataRegistry::instance().load<T>(filePath);
+      } catch (const std::exception &e) {
+        // 失败留给测试绑定数据时重新加载并上报
+        logger.warning("Prefetch failed for " + filePath + ": " + e.what());
+      }
+    });
+  }
+
+private:
+  ZDataPrefetcher() = default;
+
+  ZThreadPool &pool() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_pool)
+      _pool = std::make_unique<ZThreadPool>(2);
+    return *_pool;
+  }
+
+  std::mutex _mutex;
+  std::unique_ptr<ZThreadPool> _pool;
+  size_t _depth = 2;
+};
+
+template <typename Manager>
+// 延迟绑定数据集的参数化测试基类，数据集在测试运行时才从 ZDataRegistry 获取。
+class ZTestLazyParameterized : public ZTestBase {
+protected:
+  std::string _data_path;
+  std::shared_ptr<Manager> _dataset;
+
+public:
+  ZTestLazyParameterized(const string &name, ZType type, const string &desc,
+                         const std::string &data_path)
+      : ZTestBase(name, type, desc), _data_path(data_path) {
+    addDataFile(data_path);
+  }
+  /**
+   * @description: 请求后台预取本测试的数据集
+   */
+  void prefetchData() override {
+    ZDataPrefetcher::instance().prefetch<Manager>(_data_path);
+  }
+  /**
+   * @description: 绑定数据集并遍历所有测试用例，结束后释放对数据集的引用
+   * @return 测试执行状态（成功或失败）
+   */
+  ZState run() override {
+    _dataset = ZDataRegistry::instance().load<Manager>(_data_path);
+    struct Release {
+      std::shared_ptr<Manager> &ref;
+      ~Release() { ref.reset(); }
+    } release{_dataset};
+
+    _dataset->reset();
+    while (_dataset->has_next()) {
+      if (run_single_case() != ZState::z_success)
+        return ZState::z_failed;
+      _dataset->next();
+    }
+    return ZState::z_success;
+  }
+
+  virtual ZState run_single_case() = 0;
+};
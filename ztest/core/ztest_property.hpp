@@ -0,0 +1,508 @@
+#pragma once
+#include "ztest_base.hpp"
+#include "ztest_error.hpp"
+#include "ztest_result.hpp"
+#include "ztest_thread.hpp"
+#include "ztest_utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+// 基于性质的测试：由可组合的生成器产生随机输入，在线程池上并行检查性质，
+// 找到反例后逐步缩小为最小反例。每个用例的随机数种子只由全局种子、测试名
+// 和用例序号决定，因此并行调度不影响结果，用同一个 --seed 可以精确复现。
+
+// xoshiro256** 随机数发生器，由 splitmix64 扩展种子
+class ZRandom {
+public:
+  explicit ZRandom(uint64_t seed) {
+    for (auto &s : _state)
+      s = splitmix(seed);
+  }
+
+  uint64_t next() {
+    const uint64_t result = rotl(_state[1] * 5, 7) * 9;
+    const uint64_t t = _state[1] << 17;
+    _state[2] ^= _state[0];
+    _state[3] ^= _state[1];
+    _state[1] ^= _state[2];
+    _state[0] ^= _state[3];
+    _state[2] ^= t;
+    _state[3] = rotl(_state[3], 45);
+    return result;
+  }
+  /**
+   * @description: [lo, hi] 内均匀分布的整数
+   */
+  template <typename T> T uniform(T lo, T hi) {
+    using U = std::make_unsigned_t<T>;
+    const uint64_t range = uint64_t(U(hi) - U(lo)) + 1;
+    if (range == 0) // 覆盖整个 64 位范围
+      return T(next());
+    const uint64_t r = uint64_t((unsigned __int128)next() * range >> 64);
+    return T(U(lo) + U(r));
+  }
+  /**
+   * @description: [0, 1) 内均匀分布的浮点数
+   */
+  double unit() { return (next() >> 11) * 0x1.0p-53; }
+  bool chance(unsigned one_in) { return next() % one_in == 0; }
+
+  static uint64_t splitmix(uint64_t &x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+private:
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+  uint64_t _state[4];
+};
+
+// 生成器：generate 按规模参数 size 生成一个值，shrink 给出更“简单”的候选值
+template <typename T> class ZGenerator {
+public:
+  using value_type = T;
+  using GenerateFn = std::function<T(ZRandom &, size_t)>;
+  using ShrinkFn = std::function<std::vector<T>(const T &)>;
+
+  ZGenerator(GenerateFn generate, ShrinkFn shrink = nullptr)
+      : _generate(std::move(generate)), _shrink(std::move(shrink)) {}
+
+  T generate(ZRandom &rng, size_t size) const { return _generate(rng, size); }
+  std::vector<T> shrink(const T &value) const {
+    return _shrink ? _shrink(value) : std::vector<T>{};
+  }
+  /**
+   * @description: 对生成的值做变换，变换后的生成器不缩小
+   */
+  template <typename F> auto map(F f) const {
+    using R = std::invoke_result_t<F, const T &>;
+    auto self = *this;
+    return ZGenerator<R>(
+        [self, f](ZRandom &rng, size_t size) {
+          return f(self.generate(rng, size));
+        });
+  }
+
+private:
+  GenerateFn _generate;
+  ShrinkFn _shrink;
+};
+
+class ZGen {
+public:
+  /**
+   * @description: [lo, hi] 内的整数，偶尔取边界值和0，向0（或最接近0的边界）缩小
+   */
+  template <typename T>
+  static ZGenerator<T> integer(T lo = std::numeric_limits<T>::min(),
+                               T hi = std::numeric_limits<T>::max()) {
+    static_assert(std::is_integral_v<T>, "ZGen::integer requires an integer type");
+    const T target = lo > 0 ? lo : (hi < 0 ? hi : T(0));
+    return ZGenerator<T>(
+        [lo, hi, target](ZRandom &rng, size_t) {
+          if (rng.chance(8)) {
+            const T edges[] = {lo, hi, target};
+            return edges[rng.uniform<int>(0, 2)];
+          }
+          return rng.uniform<T>(lo, hi);
+        },
+        [target](const T &value) {
+          // 依次尝试目标值和逐步减半的差距，差距按无符号数计算以免溢出
+          using U = std::make_unsigned_t<T>;
+          std::vector<T> out;
+          const bool down = value > target;
+          const U gap = down ? U(U(value) - U(target)) : U(U(target) - U(value));
+          for (U step = gap; step > 0; step /= 2)
+            out.push_back(down ? T(U(value) - step) : T(U(value) + step));
+          return out;
+        });
+  }
+  /**
+   * @description: [lo, hi] 内的浮点数，向0、整数和一半缩小
+   */
+  template <typename T>
+  static ZGenerator<T> real(T lo = T(-1e6), T hi = T(1e6)) {
+    static_assert(std::is_floating_point_v<T>,
+                  "ZGen::real requires a floating point type");
+    const T target = lo > 0 ? lo : (hi < 0 ? hi : T(0));
+    return ZGenerator<T>(
+        [lo, hi, target](ZRandom &rng, size_t) {
+          if (rng.chance(8)) {
+            const T edges[] = {lo, hi, target};
+            return edges[rng.uniform<int>(0, 2)];
+          }
+          return T(lo + (double(hi) - double(lo)) * rng.unit());
+        },
+        [lo, hi, target](const T &value) {
+          std::vector<T> out;
+          for (T candidate : {target, std::trunc(value), T(value / 2)})
+            if (candidate != value && candidate >= lo && candidate <= hi &&
+                std::find(out.begin(), out.end(), candidate) == out.end())
+              out.push_back(candidate);
+          return out;
+        });
+  }
+  /**
+   * @description: 长度不超过 max_length（并随规模增长）的字符串，字符取自 alphabet
+   */
+  static ZGenerator<std::string>
+  string(size_t max_length = 64,
+         std::string alphabet = "abcdefghijklmnopqrstuvwxyz"
+                                "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-.") {
+    return ZGenerator<std::string>(
+        [max_length, alphabet](ZRandom &rng, size_t size) {
+          std::string out(
+              rng.uniform<size_t>(0, std::min(max_length, size)), ' ');
+          for (auto &c : out)
+            c = alphabet[rng.uniform<size_t>(0, alphabet.size() - 1)];
+          return out;
+        },
+        [alphabet](const std::string &value) {
+          std::vector<std::string> out = removals(value);
+          for (size_t i = 0; i < value.size(); ++i)
+            if (value[i] != alphabet.front()) {
+              std::string simpler = value;
+              simpler[i] = alphabet.front();
+              out.push_back(std::move(simpler));
+            }
+          return out;
+        });
+  }
+  /**
+   * @description: 长度不超过 max_length（并随规模增长）的 vector
+   */
+  template <typename T>
+  static ZGenerator<std::vector<T>> vector(ZGenerator<T> element,
+                                           size_t max_length = 64) {
+    return ZGenerator<std::vector<T>>(
+        [element, max_length](ZRandom &rng, size_t size) {
+          std::vector<T> out(
+              rng.uniform<size_t>(0, std::min(max_length, size)));
+          for (auto &value : out)
+            value = element.generate(rng, size);
+          return out;
+        },
+        [element](const std::vector<T> &value) {
+          std::vector<std::vector<T>> out = removals(value);
+          for (size_t i = 0; i < value.size(); ++i)
+            for (auto &simpler : element.shrink(value[i])) {
+              auto copy = value;
+              copy[i] = std::move(simpler);
+              out.push_back(std::move(copy));
+            }
+          return out;
+        });
+  }
+  /**
+   * @description: 组合多个生成器，逐个分量缩小
+   */
+  template <typename... T>
+  static ZGenerator<std::tuple<T...>> tuple(ZGenerator<T>... elements) {
+    auto parts = std::make_tuple(std::move(elements)...);
+    return ZGenerator<std::tuple<T...>>(
+        [parts](ZRandom &rng, size_t size) {
+          return std::apply(
+              [&](const auto &...g) {
+                // 花括号初始化保证按从左到右的顺序生成
+                return std::tuple<T...>{g.generate(rng, size)...};
+              },
+              parts);
+        },
+        [parts](const std::tuple<T...> &value) {
+          return shrinkTuple(parts, value);
+        });
+  }
+  /**
+   * @description: 逐个分量缩小元组，其余分量保持不变
+   */
+  template <typename... T>
+  static std::vector<std::tuple<T...>>
+  shrinkTuple(const std::tuple<ZGenerator<T>...> &parts,
+              const std::tuple<T...> &value) {
+    std::vector<std::tuple<T...>> out;
+    shrinkTupleAt<0>(parts, value, out);
+    return out;
+  }
+
+private:
+  template <size_t I, typename... T>
+  static void shrinkTupleAt(const std::tuple<ZGenerator<T>...> &parts,
+                            const std::tuple<T...> &value,
+                            std::vector<std::tuple<T...>> &out) {
+    if constexpr (I < sizeof...(T)) {
+      for (auto &simpler : std::get<I>(parts).shrink(std::get<I>(value))) {
+        auto copy = value;
+        std::get<I>(copy) = std::move(simpler);
+        out.push_back(std::move(copy));
+      }
+      shrinkTupleAt<I + 1>(parts, value, out);
+    }
+  }
+  /**
+   * @description: 删除一半、四分之一……直到单个元素的候选序列
+   */
+  template <typename C> static std::vector<C> removals(const C &value) {
+    std::vector<C> out;
+    for (size_t chunk = value.size(); chunk > 0; chunk /= 2)
+      for (size_t start = 0; start + chunk <= value.size(); start += chunk) {
+        C shorter;
+        shorter.reserve(value.size() - chunk);
+        shorter.insert(shorter.end(), value.begin(), value.begin() + start);
+        shorter.insert(shorter.end(), value.begin() + start + chunk,
+                       value.end());
+        out.push_back(std::move(shorter));
+      }
+    return out;
+  }
+};
+
+// 反例的文本表示
+class ZPropertyPrint {
+public:
+  template <typename T> static std::string text(const T &value) {
+    std::ostringstream out;
+    write(out, value);
+    return out.str();
+  }
+
+private:
+  template <typename T> static void write(std::ostream &out, const T &value) {
+    if constexpr (std::is_same_v<T, std::string>) {
+      out << '"' << value << '"';
+    } else if constexpr (std::is_same_v<T, char>) {
+      out << '\'' << value << '\'';
+    } else if constexpr (std::is_floating_point_v<T>) {
+      out << std::setprecision(std::numeric_limits<T>::max_digits10) << value;
+    } else if constexpr (requires { std::tuple_size<T>::value; }) {
+      out << '(';
+      std::apply(
+          [&](const auto &...parts) {
+            size_t i = 0;
+            ((out << (i++ ? ", " : ""), write(out, parts)), ...);
+          },
+          value);
+      out << ')';
+    } else if constexpr (requires { value.begin(); value.end(); }) {
+      out << '[';
+      size_t i = 0;
+      for (const auto &element : value) {
+        out << (i++ ? ", " : "");
+        write(out, element);
+      }
+      out << ']';
+    } else if constexpr (requires { out << value; }) {
+      out << value;
+    } else {
+      out << "<" << sizeof(T) << "-byte object>";
+    }
+  }
+};
+
+struct ZPropertyConfig {
+  size_t cases = 1000;      // 随机用例数
+  size_t max_size = 100;    // 规模参数上限，随用例序号线性增长
+  size_t max_shrinks = 2000; // 缩小时最多检查的候选数
+};
+
+struct ZPropertyOutcome {
+  bool passed = true;
+  ZPropertyInfo info;
+  std::string message; // 失败原因（性质返回false或异常信息）
+};
+
+// ZPropertyRunner 在独立的线程池上并行检查性质：用例按批分发，
+// 所有批次共同维护已知最小的失败用例序号，之后的用例不再检查，
+// 因此总是找到序号最小的反例，与线程数无关。
+class ZPropertyRunner {
+public:
+  /**
+   * @description: 设置全局种子，未设置时每次运行随机选取并记录在结果中
+   */
+  static ZPropertyConfig &defaultConfig() {
+    static ZPropertyConfig config;
+    return config;
+  }
+  static void setSeed(uint64_t seed) {
+    seedRef() = seed;
+    seedSetRef() = true;
+  }
+  static uint64_t getSeed() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+      if (!seedSetRef())
+        seedRef() = (uint64_t(std::random_device{}()) << 32) ^
+                    std::random_device{}();
+    });
+    return seedRef();
+  }
+  /**
+   * @description: 检查性质 check 对生成器 gen 产生的所有输入成立
+   * @param name 测试名，参与每个用例的种子计算
+   * @param gen 输入生成器
+   * @param check 性质，返回false或抛出异常表示不成立
+   * @return 检查结果，失败时包含缩小后的反例
+   */
+  template <typename T, typename F>
+  static ZPropertyOutcome run(const std::string &name,
+                              const ZGenerator<T> &gen, F check,
+                              const ZPropertyConfig &config = {}) {
+    const uint64_t seed = getSeed();
+    const uint64_t stream = seed ^ fnv1a64(name);
+    ZPropertyOutcome outcome;
+    outcome.info.seed = seed;
+
+    std::atomic<size_t> first_failure{config.cases};
+    std::atomic<size_t> checked{0};
+    const size_t workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t batch = std::max<size_t>(16, config.cases / (workers * 4));
+    std::vector<std::future<void>> futures;
+    for (size_t begin = 0; begin < config.cases; begin += batch) {
+      const size_t end = std::min(config.cases, begin + batch);
+      futures.push_back(pool().enqueue([&, begin, end] {
+        for (size_t i = begin; i < end && i < first_failure.load(); ++i) {
+          T value = generate(gen, stream, i, config);
+          checked++;
+          if (!holds(check, value).first) {
+            size_t known = first_failure.load();
+            while (i < known && !first_failure.compare_exchange_weak(known, i))
+              ;
+            return;
+          }
+        }
+      }));
+    }
+    for (auto &f : futures)
+      f.get();
+
+    const size_t failing = first_failure.load();
+    if (failing == config.cases) {
+      outcome.info.cases = config.cases;
+      return outcome;
+    }
+    // 在调用线程上确定性地缩小反例
+    T value = generate(gen, stream, failing, config);
+    outcome.passed = false;
+    outcome.info.cases = failing + 1;
+    outcome.info.original = ZPropertyPrint::text(value);
+    outcome.message = holds(check, value).second;
+    size_t budget = config.max_shrinks;
+    for (bool improved = true; improved && budget > 0;) {
+      improved = false;
+      for (auto &candidate : gen.shrink(value)) {
+        if (budget == 0)
+          break;
+        --budget;
+        auto [ok, message] = holds(check, candidate);
+        if (!ok) {
+          value = std::move(candidate);
+          outcome.message = std::move(message);
+          outcome.info.shrinks++;
+          improved = true;
+          break;
+        }
+      }
+    }
+    outcome.info.counterexample = ZPropertyPrint::text(value);
+    logger.debug("Property " + name + " checked " + std::to_string(checked) +
+                 " cases, shrunk " + std::to_string(outcome.info.shrinks) +
+                 " times");
+    return outcome;
+  }
+
+private:
+  static uint64_t &seedRef() {
+    static uint64_t seed = 0;
+    return seed;
+  }
+  static bool &seedSetRef() {
+    static bool set = false;
+    return set;
+  }
+  /**
+   * @description: 性质检查专用的线程池，与运行测试的线程池分开，避免测试线程
+   *               等待同一线程池中的任务造成死锁
+   */
+  static ZThreadPool &pool() {
+    static ZThreadPool pool(
+        std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+  }
+
+  template <typename T>
+  static T generate(const ZGenerator<T> &gen, uint64_t stream, size_t index,
+                    const ZPropertyConfig &config) {
+    uint64_t mix = stream + index;
+    ZRandom rng(ZRandom::splitmix(mix));
+    const size_t size =
+        1 + index * config.max_size / std::max<size_t>(1, config.cases);
+    return gen.generate(rng, size);
+  }
+
+  template <typename F, typename T>
+  static std::pair<bool, std::string> holds(F &check, const T &value) {
+    try {
+      bool ok;
+      if constexpr (requires { std::apply(check, value); })
+        ok = std::apply(check, value);
+      else
+        ok = check(value);
+      return {ok, ok ? "" : "property returned false"};
+    } catch (const std::exception &e) {
+      return {false, e.what()};
+    } catch (...) {
+      return {false, "unknown exception"};
+    }
+  }
+};
+
+// 性质测试基类，检查结果（种子、用例数和缩小后的反例）写入测试结果
+class ZPropertyTest : public ZTestBase {
+public:
+  using ZTestBase::ZTestBase;
+
+  void annotateResult(ZTestResult &result) const override {
+    if (_outcome.info.cases > 0)
+      result.setProperty(_outcome.info);
+  }
+  // 用例由种子生成，种子和用例数都可能随运行变化
+  bool cacheable() const override { return false; }
+
+protected:
+  /**
+   * @description: 检查性质，不成立时以缩小后的反例抛出 ZTestFailureException
+   */
+  template <typename F, typename... T>
+  ZState checkProperty(F check, const ZPropertyConfig &config,
+                       ZGenerator<T>... gens) {
+    _outcome =
+        ZPropertyRunner::run(getName(), ZGen::tuple(std::move(gens)...),
+                             check, config);
+    if (!_outcome.passed)
+      throw ZTestFailureException(
+          getName(), "property holds for all inputs",
+          "falsified by " + _outcome.info.counterexample + " after " +
+              std::to_string(_outcome.info.cases) + " cases and " +
+              std::to_string(_outcome.info.shrinks) + " shrinks (" +
+              _outcome.message + "); reproduce with --seed " +
+              std::to_string(_outcome.info.seed));
+    return ZState::z_success;
+  }
+
+  ZPropertyOutcome _outcome;
+};
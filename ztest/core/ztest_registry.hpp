@@ -4,11 +4,14 @@
 #include "ztest_types.hpp"
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 // ZTestRegistry定义了测试注册中心，用于gtest类似语法。
 class ZTestRegistry {
 private:
   vector<shared_ptr<ZTestBase>> _tests; // 所有被注册的测试用例
+  // 目标测试尚未注册时暂存的配置，注册时应用
+  unordered_map<string, vector<function<void(ZTestBase &)>>> _pending;
   mutex _mutex;
 
 public:
@@ -27,8 +30,29 @@ public:
    */
   void addTest(shared_ptr<ZTestBase> test) {
     lock_guard<mutex> lock(_mutex);
+    if (auto it = _pending.find(test->getName()); it != _pending.end()) {
+      for (auto &config : it->second)
+        config(*test);
+      _pending.erase(it);
+    }
     _tests.push_back(test);
   }
+  /**
+   * @description: 配置已注册或稍后注册的测试（如声明依赖和资源），
+   *               不受跨编译单元的静态初始化顺序影响
+   * @param name 测试全名
+   * @param config 配置函数
+   */
+  void configure(const string &name, function<void(ZTestBase &)> config) {
+    lock_guard<mutex> lock(_mutex);
+    for (auto &test : _tests) {
+      if (test->getName() == name) {
+        config(*test);
+        return;
+      }
+    }
+    _pending[name].push_back(move(config));
+  }
   /**
    * @description: 获取所有测试用例
    * @return 所有测试用例
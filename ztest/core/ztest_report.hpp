@@ -0,0 +1,874 @@
+#pragma once
+#include "ztest_ai.hpp"
+#include "ztest_logger.hpp"
+#include "ztest_result.hpp"
+#include "ztest_utils.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+// 报告转义工具，按输出格式处理用户可控的文本（测试名、错误信息、AI建议）。
+class ZReportEscape {
+public:
+  /**
+   * @description: 写出JSON字符串内容（不含两侧引号）
+   */
+  static void json(std::ostream &out, std::string_view text) {
+    for (char c : text) {
+      switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\r':
+        out << "\\r";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out << buf;
+        } else {
+          out << c;
+        }
+      }
+    }
+  }
+  /**
+   * @description: 写出XML/HTML文本或属性值
+   */
+  static void xml(std::ostream &out, std::string_view text) {
+    for (char c : text) {
+      switch (c) {
+      case '&':
+        out << "&amp;";
+        break;
+      case '<':
+        out << "&lt;";
+        break;
+      case '>':
+        out << "&gt;";
+        break;
+      case '"':
+        out << "&quot;";
+        break;
+      case '\'':
+        out << "&apos;";
+        break;
+      case '\n':
+        out << "&#10;";
+        break;
+      default:
+        // XML 1.0 不允许除制表、换行、回车外的控制字符
+        if (static_cast<unsigned char>(c) >= 0x20 || c == '\t' || c == '\r')
+          out << c;
+      }
+    }
+  }
+  /**
+   * @description: 写出JavaScript模板字符串内容，防止提前闭合反引号或script标签
+   */
+  static void js(std::ostream &out, std::string_view text) {
+    for (size_t i = 0; i < text.size(); ++i) {
+      char c = text[i];
+      if (c == '\\' || c == '`')
+        out << '\\' << c;
+      else if (c == '$' && i + 1 < text.size() && text[i + 1] == '{')
+        out << "\\$";
+      else if (c == '<' && i + 1 < text.size() && text[i + 1] == '/')
+        out << "<\\";
+      else
+        out << c;
+    }
+  }
+};
+
+// 带大缓冲区的报告文件输出流，减少逐行写入时的系统调用。
+class ZReportSink {
+public:
+  static constexpr size_t kBufferSize = 1 << 20;
+
+  explicit ZReportSink(const std::string &path)
+      : _path(path), _buffer(new char[kBufferSize]) {
+    _file.rdbuf()->pubsetbuf(_buffer.get(), kBufferSize);
+    _file.open(path, std::ios::out | std::ios::trunc);
+    if (!_file)
+      logger.error("Failed to open report file: " + path);
+  }
+  ~ZReportSink() { close(); }
+
+  bool good() const { return static_cast<bool>(_file); }
+  std::ostream &out() { return _file; }
+  void close() {
+    if (_file.is_open()) {
+      _file.close();
+      if (_file.fail())
+        logger.error("Failed to write report file: " + _path);
+    }
+  }
+
+private:
+  std::string _path;
+  std::unique_ptr<char[]> _buffer; // 须先于_file析构
+  std::ofstream _file;
+};
+
+struct ZReportOptions {
+  bool html = true;
+  bool json = true;
+  bool junit = true;
+  bool generateAI = true;
+  std::string htmlPath = "test_report.html";
+  std::string jsonPath = "test_report.json";
+  std::string junitPath = "test_report.xml";
+  std::string testFilePath; // 非空时将测试源码附加到AI提示中
+};
+
+// ZReportWriter 在一次遍历结果表的过程中同时写出 JSON、JUnit 和 HTML 报告。
+// 统计数据由 ZTestResultManager 增量维护，遍历期间不复制结果。
+class ZReportWriter {
+public:
+  explicit ZReportWriter(ZReportOptions options)
+      : _options(std::move(options)) {}
+
+  void write() {
+    std::unique_ptr<ZReportSink> json, junit, html;
+    if (_options.json)
+      json = openSink(_options.jsonPath);
+    if (_options.junit)
+      junit = openSink(_options.junitPath);
+    if (_options.html)
+      html = openSink(_options.htmlPath);
+    if (!json && !junit && !html)
+      return;
+    logger.debug("Generating reports");
+
+    ZResultTally summary;
+    std::map<std::string, ZResultTally> suites;
+    std::string current_suite;
+    bool first_test = true;
+    // "Other" 套件的结果在名称顺序中不连续，收集后最后写出
+    std::vector<ZTestResult> others;
+    // 失败分组编号按数量降序从1开始，HTML中重复的失败只链接到分组
+    const auto buckets = ZTestResultManager::getInstance().getFailureBuckets();
+    std::unordered_map<uint64_t, size_t> bucket_ids;
+    for (size_t i = 0; i < buckets.size(); ++i)
+      bucket_ids[buckets[i].signature] = i + 1;
+
+    ZTestResultManager::getInstance().forEachResult(
+        [&](const ZTestResult &result) {
+          const std::string suite = ZTestResultManager::suiteOf(result.getName());
+          if (json) {
+            if (!first_test)
+              json->out() << ",\n";
+            writeJsonTest(json->out(), result);
+          }
+          first_test = false;
+          if (junit) {
+            if (suite == "Other") {
+              others.push_back(result);
+            } else {
+              if (suite != current_suite) {
+                if (!current_suite.empty())
+                  junit->out() << "  </testsuite>\n";
+                writeJUnitSuiteOpen(junit->out(), suite, suites[suite]);
+                current_suite = suite;
+              }
+              writeJUnitTest(junit->out(), suite, result);
+            }
+          }
+          if (html) {
+            size_t bucket_id = 0;
+            if (result.getState() == ZState::z_failed) {
+              auto it = bucket_ids.find(ZFailureClusters::signature(
+                  result.getName(), result.getErrorMsg()));
+              if (it != bucket_ids.end() &&
+                  buckets[it->second - 1].count() > 1)
+                bucket_id = it->second;
+            }
+            writeHtmlRow(html->out(), result, bucket_id);
+          }
+        },
+        [&](const ZResultTally &s,
+            const std::map<std::string, ZResultTally> &t) {
+          summary = s;
+          suites = t;
+          if (json)
+            writeJsonHeader(json->out(), summary);
+          if (junit)
+            junit->out() << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                         << "<testsuites>\n";
+          if (html)
+            writeHtmlHeader(html->out(), summary);
+        });
+
+    if (json) {
+      json->out() << "\n  ],\n";
+      writeJsonBuckets(json->out(), buckets);
+      json->out() << "\n}";
+      json->close();
+    }
+    if (junit) {
+      if (!current_suite.empty())
+        junit->out() << "  </testsuite>\n";
+      if (!others.empty()) {
+        writeJUnitSuiteOpen(junit->out(), "Other", suites["Other"]);
+        for (const auto &result : others)
+          writeJUnitTest(junit->out(), "Other", result);
+        junit->out() << "  </testsuite>\n";
+      }
+      junit->out() << "</testsuites>\n";
+      junit->close();
+    }
+    if (html) {
+      // 报告先以占位内容写完，AI分析返回后再截断到AI区块并重写
+      html->out() << "        </tbody>\n"
+                  << "    </table>\n";
+      writeHtmlBuckets(html->out(), buckets);
+      const std::streamoff footer_offset = html->out().tellp();
+      writeHtmlFooter(html->out(), _options.generateAI ? "*正在生成AI分析...*"
+                                                       : "No AI advice");
+      html->close();
+      if (_options.generateAI) {
+        ZAIRequest ai_request;
+        ai_request.summary = summary;
+        ai_request.failures = buckets;
+        ai_request.prompt = buildPrompt(ai_request);
+        // 超时后才返回的分析在报告未被重新生成时补写进去
+        const std::string path = _options.htmlPath;
+        std::error_code ec;
+        const std::uintmax_t placeholder_size =
+            std::filesystem::file_size(path, ec);
+        const std::string text = ZAIAnalyzer::instance().analyze(
+            std::move(ai_request),
+            [path, footer_offset, placeholder_size](const std::string &late) {
+              patchHtmlFooter(path, footer_offset, placeholder_size, late,
+                              true);
+            });
+        patchHtmlFooter(path, footer_offset, placeholder_size, text, false);
+      }
+    }
+  }
+
+private:
+  static std::unique_ptr<ZReportSink> openSink(const std::string &path) {
+    auto sink = std::make_unique<ZReportSink>(path);
+    if (!sink->good())
+      return nullptr;
+    sink->out() << std::fixed;
+    return sink;
+  }
+
+  static const char *counterKind(const ZCounter &counter) {
+    return counter.kind == ZCounterKind::z_rate ? "rate" : "average";
+  }
+
+  static const char *statusText(const ZTestResult &result) {
+    return result.getState() == ZState::z_success ? "Passed" : "Failed";
+  }
+
+  static void writeJsonHeader(std::ostream &out, const ZResultTally &summary) {
+    out << "{\n"
+        << "  \"summary\": {\n"
+        << "    \"total\": " << summary.total << ",\n"
+        << "    \"passed\": " << summary.passed << ",\n"
+        << "    \"failed\": " << summary.failed << "\n"
+        << "  },\n"
+        << "  \"tests\": [\n";
+  }
+
+  static void writeJsonTest(std::ostream &out, const ZTestResult &result) {
+    out << "    {\n"
+        << "      \"name\": \"";
+    ZReportEscape::json(out, result.getName());
+    out << "\",\n"
+        << "      \"status\": \"" << statusText(result) << "\",\n"
+        << "      \"duration\": " << std::setprecision(2)
+        << result.getUsedTime() << ",\n"
+        << "      \"cached\": " << (result.isCached() ? "true" : "false")
+        << ",\n";
+    if (result.getFixtureTime() > 0)
+      out << "      \"fixture_ms\": " << result.getFixtureTime() << ",\n";
+    out << "      \"error\": \"";
+    ZReportEscape::json(out, result.getErrorMsg());
+    out << "\"";
+    const auto &failures = result.getFailures();
+    if (!failures.empty()) {
+      out << ",\n      \"failures\": [";
+      for (size_t i = 0; i < failures.size(); ++i) {
+        const auto &failure = failures[i];
+        out << (i ? ",\n" : "\n") << "        {\"file\": \"";
+        ZReportEscape::json(out, failure.file);
+        out << "\", \"line\": " << failure.line << ", \"expression\": \"";
+        ZReportEscape::json(out, failure.expression);
+        out << "\", \"fatal\": " << (failure.fatal ? "true" : "false")
+            << ", \"message\": \"";
+        ZReportEscape::json(out, failure.message);
+        out << "\"}";
+      }
+      out << "\n      ]";
+    }
+    if (const auto &property = result.getProperty()) {
+      out << ",\n      \"property\": {\"seed\": " << property->seed
+          << ", \"cases\": " << property->cases
+          << ", \"shrinks\": " << property->shrinks
+          << ", \"counterexample\": \"";
+      ZReportEscape::json(out, property->counterexample);
+      out << "\", \"original\": \"";
+      ZReportEscape::json(out, property->original);
+      out << "\"}";
+    }
+    if (const auto &env = result.getEnvironment()) {
+      out << ",\n      \"environment\": {\"cpu\": " << env->cpu
+          << ", \"governor\": \"";
+      ZReportEscape::json(out, env->governor);
+      out << "\", \"turbo\": \"" << env->turbo << "\", \"smt_siblings\": \""
+          << env->smt_siblings << "\", \"load_before\": " << env->load_before
+          << ", \"load_after\": " << env->load_after
+          << ", \"throttle_events\": " << env->throttle_events
+          << ", \"voluntary_switches\": " << env->voluntary_switches
+          << ", \"involuntary_switches\": " << env->involuntary_switches
+          << ", \"warnings\": [";
+      for (size_t i = 0; i < env->warnings.size(); ++i) {
+        out << (i ? ", \"" : "\"");
+        ZReportEscape::json(out, env->warnings[i]);
+        out << "\"";
+      }
+      out << "]}";
+    }
+    const auto &counters = result.getCounters();
+    if (!counters.empty()) {
+      out << ",\n      \"counters\": [";
+      for (size_t i = 0; i < counters.size(); ++i) {
+        out << (i ? ", " : "") << "{\"name\": \"";
+        ZReportEscape::json(out, counters[i].name);
+        out << "\", \"value\": " << counters[i].value << ", \"kind\": \""
+            << counterKind(counters[i]) << "\"}";
+      }
+      out << "]";
+    }
+    if (const auto &cold = result.getColdStart()) {
+      out << ",\n      \"cold_start\": {\"parallel\": " << cold->parallel
+          << ", \"failed\": " << cold->failed << ", \"metrics\": {";
+      for (size_t i = 0; i < cold->metrics.size(); ++i) {
+        const auto &m = cold->metrics[i];
+        out << (i ? ",\n" : "\n") << "        \"" << m.name
+            << "\": {\"mean\": " << m.mean << ", \"min\": " << m.min
+            << ", \"p50\": " << m.p50 << ", \"p90\": " << m.p90
+            << ", \"p99\": " << m.p99 << ", \"max\": " << m.max << "}";
+      }
+      out << "\n      }, \"samples\": [";
+      for (size_t i = 0; i < cold->samples.size(); ++i) {
+        const auto &c = cold->samples[i];
+        out << (i ? ",\n" : "\n") << "        {\"cpu\": " << c.cpu
+            << ", \"startup_ns\": " << c.startup_ns
+            << ", \"first_call_ns\": " << c.first_call_ns
+            << ", \"process_ns\": " << c.process_ns
+            << ", \"startup_minor_faults\": " << c.startup_minor_faults
+            << ", \"startup_major_faults\": " << c.startup_major_faults
+            << ", \"first_call_minor_faults\": " << c.first_call_minor_faults
+            << ", \"first_call_major_faults\": " << c.first_call_major_faults
+            << "}";
+      }
+      out << "\n      ]}";
+    }
+    if (const auto &load = result.getLoad()) {
+      out << ",\n      \"load\": {\"knee_rate\": " << load->knee_rate
+          << ", \"mean_ns\": " << load->mean_ns << ", \"saturation\": \"";
+      ZReportEscape::json(out, load->saturation);
+      out << "\", \"points\": [";
+      for (size_t i = 0; i < load->points.size(); ++i) {
+        const auto &p = load->points[i];
+        out << (i ? ",\n" : "\n") << "        {\"target_rate\": "
+            << p.target_rate << ", \"achieved_rate\": " << p.achieved_rate
+            << ", \"requests\": " << p.requests << ", \"mean_ns\": " << p.mean_ns
+            << ", \"p50_ns\": " << p.p50_ns << ", \"p90_ns\": " << p.p90_ns
+            << ", \"p99_ns\": " << p.p99_ns << ", \"p999_ns\": " << p.p999_ns
+            << ", \"max_ns\": " << p.max_ns
+            << ", \"saturated\": " << (p.saturated ? "true" : "false") << "}";
+      }
+      out << "\n      ]}";
+    }
+    if (const auto &soak = result.getSoak()) {
+      const auto trend = [&out](const char *name, const ZTrend &t) {
+        out << ", \"" << name << "\": {\"z\": " << t.z
+            << ", \"p_value\": " << t.p_value << ", \"slope\": " << t.slope
+            << ", \"increasing\": " << (t.increasing ? "true" : "false")
+            << "}";
+      };
+      out << ",\n      \"soak\": {\"duration_s\": " << soak->duration_s
+          << ", \"iterations\": " << soak->iterations
+          << ", \"mean_ns\": " << soak->mean_ns
+          << ", \"p50_ns\": " << soak->p50_ns << ", \"p90_ns\": " << soak->p90_ns
+          << ", \"p99_ns\": " << soak->p99_ns
+          << ", \"p999_ns\": " << soak->p999_ns
+          << ", \"max_ns\": " << soak->max_ns;
+      trend("rss_trend", soak->rss_trend);
+      trend("latency_trend", soak->latency_trend);
+      out << ", \"warnings\": [";
+      for (size_t i = 0; i < soak->warnings.size(); ++i) {
+        out << (i ? ", \"" : "\"");
+        ZReportEscape::json(out, soak->warnings[i]);
+        out << "\"";
+      }
+      out << "], \"windows\": [";
+      for (size_t i = 0; i < soak->windows.size(); ++i) {
+        const auto &w = soak->windows[i];
+        out << (i ? ", " : "") << "{\"t_s\": " << w.t_s
+            << ", \"count\": " << w.count << ", \"mean_ns\": " << w.mean_ns
+            << ", \"p50_ns\": " << w.p50_ns << ", \"p99_ns\": " << w.p99_ns
+            << ", \"max_ns\": " << w.max_ns << ", \"rss_kb\": " << w.rss_kb
+            << "}";
+      }
+      out << "]}";
+    }
+    const auto &scaling = result.getScaling();
+    if (!scaling.empty()) {
+      out << ",\n      \"scaling\": [";
+      for (size_t i = 0; i < scaling.size(); ++i) {
+        const auto &point = scaling[i];
+        out << (i ? ",\n" : "\n") << "        {\"threads\": " << point.threads
+            << ", \"wall_ms\": " << point.wall_ms
+            << ", \"throughput\": " << point.throughput
+            << ", \"speedup\": " << point.speedup
+            << ", \"efficiency\": " << point.efficiency << ", \"thread_ms\": [";
+        for (size_t t = 0; t < point.thread_ms.size(); ++t)
+          out << (t ? ", " : "") << point.thread_ms[t];
+        out << "]}";
+      }
+      out << "\n      ]";
+    }
+    out << "\n"
+        << "    }";
+  }
+
+  static void writeJUnitSuiteOpen(std::ostream &out, const std::string &suite,
+                                  const ZResultTally &tally) {
+    out << "  <testsuite name=\"";
+    ZReportEscape::xml(out, suite);
+    out << "\" tests=\"" << tally.total << "\" failures=\"" << tally.failed
+        << "\" errors=\"0\" time=\"" << std::setprecision(3)
+        << tally.duration / 1000.0 << "\">\n";
+  }
+
+  static void writeJUnitTest(std::ostream &out, const std::string &suite,
+                             const ZTestResult &result) {
+    out << "    <testcase name=\"";
+    ZReportEscape::xml(out, result.getName());
+    out << "\" classname=\"";
+    ZReportEscape::xml(out, suite);
+    out << "\" time=\"" << std::setprecision(3)
+        << result.getUsedTime() / 1000.0 << "\">";
+    const auto &property = result.getProperty();
+    const auto &counters = result.getCounters();
+    if (property || !counters.empty())
+      out << "\n      <properties>";
+    if (property) {
+      out << "\n        <property name=\"seed\" value=\"" << property->seed
+          << "\"/>\n        <property name=\"cases\" value=\""
+          << property->cases << "\"/>";
+      if (!property->counterexample.empty()) {
+        out << "\n        <property name=\"counterexample\" value=\"";
+        ZReportEscape::xml(out, property->counterexample);
+        out << "\"/>";
+      }
+    }
+    // 速率计数器的属性名带 _per_second 后缀
+    for (const auto &counter : counters) {
+      out << "\n        <property name=\"";
+      ZReportEscape::xml(out, counter.name);
+      if (counter.kind == ZCounterKind::z_rate)
+        out << "_per_second";
+      out << "\" value=\"" << std::setprecision(3) << counter.value << "\"/>";
+    }
+    if (property || !counters.empty())
+      out << "\n      </properties>";
+    if (result.getState() == ZState::z_failed &&
+        result.getFailures().empty()) {
+      out << "\n      <failure message=\"";
+      ZReportEscape::xml(out, result.getErrorMsg());
+      out << "\"/>";
+    }
+    // 每个失败的断言一个 <failure> 元素，与 gtest 的输出一致
+    for (const auto &failure : result.getFailures()) {
+      out << "\n      <failure message=\"";
+      if (!failure.file.empty()) {
+        ZReportEscape::xml(out, failure.file);
+        out << ":" << failure.line << " ";
+      }
+      ZReportEscape::xml(out, failure.expression.empty() ? failure.message
+                                                         : failure.expression);
+      out << "\" type=\"" << (failure.fatal ? "fatal" : "non-fatal") << "\">";
+      ZReportEscape::xml(out, failure.message);
+      out << "</failure>";
+    }
+    if (result.isCached())
+      out << "\n      <system-out>[cached]</system-out>";
+    out << "</testcase>\n";
+  }
+
+  /**
+   * @description: 写出JSON的失败分组数组，每组最多列出 kBucketSampleSize 个测试名
+   */
+  static void writeJsonBuckets(std::ostream &out,
+                               const std::vector<ZFailureBucket> &buckets) {
+    out << "  \"failure_buckets\": [";
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      const auto &bucket = buckets[i];
+      out << (i ? ",\n" : "\n") << "    {\n"
+          << "      \"signature\": \"" << hashToHex(bucket.signature) << "\",\n"
+          << "      \"count\": " << bucket.count() << ",\n"
+          << "      \"pattern\": \"";
+      ZReportEscape::json(out, bucket.pattern);
+      out << "\",\n"
+          << "      \"example\": \"";
+      ZReportEscape::json(out, bucket.example);
+      out << "\",\n"
+          << "      \"tests\": [";
+      size_t n = 0;
+      for (const auto &name : bucket.tests) {
+        if (n == kBucketSampleSize)
+          break;
+        out << (n++ ? ", \"" : "\"");
+        ZReportEscape::json(out, name);
+        out << "\"";
+      }
+      out << "]\n"
+          << "    }";
+    }
+    out << (buckets.empty() ? "]" : "\n  ]");
+  }
+
+  static void writeHtmlBuckets(std::ostream &out,
+                               const std::vector<ZFailureBucket> &buckets) {
+    if (buckets.empty())
+      return;
+    out << "    <table>\n"
+        << "        <thead>\n"
+        << "            <tr>\n"
+        << "                <th>失败分组</th>\n"
+        << "                <th>数量</th>\n"
+        << "                <th>错误信息（示例）</th>\n"
+        << "                <th>测试用例</th>\n"
+        << "            </tr>\n"
+        << "        </thead>\n"
+        << "        <tbody>\n";
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      const auto &bucket = buckets[i];
+      out << "            <tr id=\"failure-" << i + 1 << "\">\n"
+          << "                <td>#" << i + 1 << "</td>\n"
+          << "                <td>" << bucket.count() << "</td>\n"
+          << "                <td>";
+      ZReportEscape::xml(out, bucket.example);
+      out << "</td>\n"
+          << "                <td>";
+      size_t n = 0;
+      for (const auto &name : bucket.tests) {
+        if (n == kBucketSampleSize)
+          break;
+        if (n++)
+          out << ", ";
+        ZReportEscape::xml(out, name);
+      }
+      if (bucket.count() > n)
+        out << " 等 " << bucket.count() << " 个";
+      out << "</td>\n"
+          << "            </tr>\n";
+    }
+    out << "        </tbody>\n"
+        << "    </table>\n";
+  }
+
+  /**
+   * @description: 以列表写出一个测试的多个失败，每项带文件和行号
+   */
+  static void writeHtmlFailures(std::ostream &out,
+                                const std::vector<ZTestFailure> &failures) {
+    out << "<ol class=\"failures\">";
+    for (const auto &failure : failures) {
+      out << "<li>";
+      if (!failure.file.empty()) {
+        out << "<code>";
+        ZReportEscape::xml(out, failure.file);
+        out << ":" << failure.line << "</code> ";
+      }
+      ZReportEscape::xml(out, failure.message);
+      out << "</li>";
+    }
+    out << "</ol>";
+  }
+
+  static void writeHtmlRow(std::ostream &out, const ZTestResult &result,
+                           size_t bucket_id) {
+    const bool passed = result.getState() == ZState::z_success;
+    out << "            <tr>\n"
+        << "                <td>";
+    ZReportEscape::xml(out, result.getName());
+    out << "</td>\n"
+        << "                <td><span class=\"status-badge "
+        << (passed ? "success" : "failed") << "\">"
+        << (passed ? (result.isCached() ? "通过 (缓存)" : "通过") : "失败")
+        << "</span></td>\n"
+        << "                <td>" << std::setprecision(2)
+        << result.getUsedTime() << " ms</td>\n"
+        << "                <td>" << toString(result.getType()) << "</td>\n"
+        << "                <td>";
+    if (result.getErrorMsg().empty())
+      out << "-";
+    else if (bucket_id > 0)
+      out << "<a href=\"#failure-" << bucket_id << "\">见失败分组 #"
+          << bucket_id << "</a>";
+    else if (result.getFailures().size() > 1)
+      writeHtmlFailures(out, result.getFailures());
+    else
+      ZReportEscape::xml(out, result.getErrorMsg());
+    out << "</td>\n"
+        << "            </tr>\n";
+  }
+
+  static void writeHtmlHeader(std::ostream &out, const ZResultTally &summary) {
+    out << "<!DOCTYPE html>\n"
+        << "<html lang=\"zh-CN\">\n"
+        << "<head>\n"
+        << "    <meta charset=\"UTF-8\">\n"
+        << "    <title>ZTest 测试报告</title>\n"
+        << "    <script "
+           "src='https://cdn.jsdelivr.net/npm/markdown-it@14.0.0/dist/"
+           "markdown-it.min.js'></script>\n"
+        << "    <style>\n"
+        << "        :root {\n"
+        << "            --primary-color: #2c3e50;\n"
+        << "            --success-color: #27ae60;\n"
+        << "            --fail-color: #c0392b;\n"
+        << "            --hover-color: #f8f9fa;\n"
+        << "        }\n"
+        << "        body {\n"
+        << "            font-family: 'Segoe UI', system-ui, sans-serif;\n"
+        << "            line-height: 1.6;\n"
+        << "            color: #34495e;\n"
+        << "            margin: 0;\n"
+        << "            padding: 20px;\n"
+        << "        }\n"
+        << "        .header {\n"
+        << "            background: var(--primary-color);\n"
+        << "            color: white;\n"
+        << "            padding: 2rem;\n"
+        << "            border-radius: 8px;\n"
+        << "            margin: 2rem auto;\n"
+        << "            width: 80%;\n"
+        << "            box-sizing: border-box;\n"
+        << "            box-shadow: 0 2px 4px rgba(0,0,0,0.1);\n"
+        << "            text-align: center;\n"
+        << "        }\n"
+        << "        table {\n"
+        << "            width: 80%;\n"
+        << "            margin: 2rem auto;\n"
+        << "            border-collapse: collapse;\n"
+        << "            background: white;\n"
+        << "            box-shadow: 0 1px 3px rgba(0,0,0,0.1);\n"
+        << "            border-radius: 8px;\n"
+        << "            overflow: hidden;\n"
+        << "        }\n"
+        << "        th, td {\n"
+        << "            padding: 12px 15px;\n"
+        << "            text-align: left;\n"
+        << "            border-bottom: 1px solid #ecf0f1;\n"
+        << "        }\n"
+        << "        th {\n"
+        << "            background-color: var(--primary-color);\n"
+        << "            color: white;\n"
+        << "        }\n"
+        << "        tr:hover { background-color: var(--hover-color); }\n"
+        << "        .status-badge {\n"
+        << "            display: inline-block;\n"
+        << "            padding: 4px 12px;\n"
+        << "            border-radius: 20px;\n"
+        << "            font-size: 0.9em;\n"
+        << "            font-weight: 500;\n"
+        << "        }\n"
+        << "        .success { background-color: var(--success-color); color: "
+           "white; }\n"
+        << "        .failed { background-color: var(--fail-color); color: "
+           "white; }\n"
+        << "        .failures { margin: 0; padding-left: 1.2em; }\n"
+        << "        .failures li { white-space: pre-wrap; }\n"
+        << "        .summary-card {\n"
+        << "            display: flex;\n"
+        << "            justify-content: center;\n"
+        << "            gap: 2rem;\n"
+        << "            margin: 2rem auto;\n"
+        << "            padding: 1.5rem;\n"
+        << "            width: 80%;\n"
+        << "            background: white;\n"
+        << "            border-radius: 8px;\n"
+        << "            box-shadow: 0 1px 3px rgba(0,0,0,0.1);\n"
+        << "        }\n"
+        << "        .ai-analysis {\n"
+        << "            margin: 2rem auto;\n"
+        << "            width: 80%;\n"
+        << "            background: white;\n"
+        << "            padding: 1.5rem;\n"
+        << "            border-radius: 8px;\n"
+        << "            box-shadow: 0 1px 3px rgba(0,0,0,0.1);\n"
+        << "        }\n"
+        << "    </style>\n"
+        << "</head>\n"
+        << "<body>\n"
+        << "    <div class=\"header\">ZTest 测试报告</div>\n"
+        << "    <div class=\"summary-card\">\n"
+        << "        <div class=\"summary-item\">\n"
+        << "            <strong style='font-size: 2rem;'>" << summary.total
+        << "</strong>\n"
+        << "            <div>总测试用例</div>\n"
+        << "        </div>\n"
+        << "        <div class=\"summary-item\">\n"
+        << "            <strong style='color: var(--success-color); "
+           "font-size: 2rem;'>"
+        << summary.passed << "</strong>\n"
+        << "            <div>通过</div>\n"
+        << "        </div>\n"
+        << "        <div class=\"summary-item\">\n"
+        << "            <strong style='color: var(--fail-color); font-size: "
+           "2rem;'>"
+        << summary.failed << "</strong>\n"
+        << "            <div>失败</div>\n"
+        << "        </div>\n"
+        << "    </div>\n"
+        << "    <table>\n"
+        << "        <thead>\n"
+        << "            <tr>\n"
+        << "                <th>测试用例</th>\n"
+        << "                <th>状态</th>\n"
+        << "                <th>耗时 (ms)</th>\n"
+        << "                <th>类型</th>\n"
+        << "                <th>错误信息</th>\n"
+        << "            </tr>\n"
+        << "        </thead>\n"
+        << "        <tbody>\n";
+  }
+
+  static void writeHtmlFooter(std::ostream &out, const std::string &ai_advice) {
+    out << "    <div class=\"ai-analysis\">\n"
+        << "        <h3 style='color: var(--primary-color); margin-bottom: "
+           "1rem;'>AI分析报告</h3>\n"
+        << "        <div id=\"ai-content\" style='padding: 1rem; background: "
+           "#f8f9fa; border-radius: 4px;'>"
+        << "正在加载AI分析结果...</div>\n"
+        << "    </div>\n"
+        << "    <script>\n"
+        << "        document.addEventListener('DOMContentLoaded', () => {\n"
+        << "            const md = window.markdownit({html: true, linkify: "
+           "true});\n"
+        << "            const aiContent = `";
+    ZReportEscape::js(out, ai_advice);
+    out << "`;\n"
+        << "            const container = "
+           "document.getElementById('ai-content');\n"
+        << "            if (container && aiContent.trim()) {\n"
+        << "                container.innerHTML = md.render(aiContent);\n"
+        << "            } else {\n"
+        << "                container.innerHTML = "
+           "'<em>未能获取AI分析结果</em>';\n"
+        << "            }\n"
+        << "        });\n"
+        << "    </script>\n"
+        << "</body>\n"
+        << "</html>";
+  }
+  /**
+   * @description: 把报告末尾的AI区块替换为分析结果
+   * @param placeholder_size 写入占位内容后的文件大小
+   * @param late 超时后才返回的结果，可以替换占位内容或超时说明；
+   *             否则只替换占位内容（晚到的结果可能已先写入）
+   */
+  static void patchHtmlFooter(const std::string &path, std::streamoff offset,
+                              std::uintmax_t placeholder_size,
+                              const std::string &ai_advice, bool late) {
+    // 报告被重新生成后大小不再匹配，不再补写
+    static std::mutex mutex;
+    static std::map<std::string, std::uintmax_t> patched_size;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(path, ec);
+    if (size != placeholder_size && (!late || size != patched_size[path]))
+      return;
+    std::filesystem::resize_file(path, static_cast<std::uintmax_t>(offset),
+                                 ec);
+    if (ec) {
+      logger.error("Failed to patch report " + path + ": " + ec.message());
+      return;
+    }
+    {
+      std::ofstream out(path, std::ios::out | std::ios::app);
+      writeHtmlFooter(out, ai_advice);
+    }
+    patched_size[path] = std::filesystem::file_size(path, ec);
+  }
+  /**
+   * @description: 根据统计和失败列表构造AI提示词
+   */
+  std::string buildPrompt(const ZAIRequest &request) const {
+    const auto &summary = request.summary;
+    std::string prompt = "请根据以下单元测试结果生成中文分析报告：\n\n"
+                         "### 测试统计\n"
+                         "- 总测试用例: " +
+                         std::to_string(summary.total) +
+                         "\n"
+                         "- 通过: " +
+                         std::to_string(summary.passed) +
+                         "\n"
+                         "- 失败: " +
+                         std::to_string(summary.failed) +
+                         "\n\n"
+                         "### 失败用例详情（按错误特征去重）\n";
+    for (const auto &bucket : request.failures) {
+      prompt += "- [" + std::to_string(bucket.count()) + " 个用例] " +
+                bucket.example + "\n  用例: ";
+      size_t n = 0;
+      for (const auto &name : bucket.tests) {
+        if (n == kBucketSampleSize)
+          break;
+        prompt += (n++ ? ", " : "") + name;
+      }
+      if (bucket.count() > n)
+        prompt += " 等";
+      prompt += "\n";
+    }
+    if (!_options.testFilePath.empty()) {
+      std::ifstream test_file_stream(_options.testFilePath);
+      if (test_file_stream) {
+        std::string test_file_content(
+            (std::istreambuf_iterator<char>(test_file_stream)),
+            std::istreambuf_iterator<char>());
+        prompt += "### 测试文件内容\n" + test_file_content + "\n\n";
+      }
+    }
+    prompt += "\n请提供以下内容(不多于100字)：\n"
+              "1. 识别失败的根本原因\n"
+              "2. 提供修复建议\n"
+              "3. 指出高风险测试用例\n"
+              "4. 评估整体测试覆盖率\n"
+              "5. 提出系统稳定性改进建议\n";
+    return prompt;
+  }
+
+  static constexpr size_t kBucketSampleSize = 20;
+
+  ZReportOptions _options;
+};
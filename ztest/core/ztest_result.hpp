@@ -1,10 +1,143 @@
 #pragma once
 #include "ztest_base.hpp"
+#include "ztest_cluster.hpp"
 #include "ztest_timer.hpp"
+#include <algorithm>
+#include <functional>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <ostream>
 #include <sstream>
 #include <vector>
+// 性质测试的检查信息，seed 可通过 --seed 复现
+struct ZPropertyInfo {
+  uint64_t seed = 0;
+  size_t cases = 0;          // 检查的用例数（失败时为首个反例的序号+1）
+  size_t shrinks = 0;        // 反例被成功缩小的次数
+  std::string original;       // 缩小前的反例
+  std::string counterexample; // 缩小后的反例
+};
+
+// 基准测试运行时的环境，/sys 中读不到的项为空
+struct ZBenchEnvironment {
+  int cpu = -1;                    // 运行基准测试的 CPU
+  std::string governor;            // 调频策略
+  std::string turbo;               // "on"/"off"
+  std::string smt_siblings;        // 与该 CPU 共享物理核心的逻辑 CPU 列表
+  double load_before = 0.0;        // 1分钟平均负载
+  double load_after = 0.0;
+  uint64_t throttle_events = 0;    // 运行期间的温控降频次数
+  long voluntary_switches = 0;     // 基准线程的主动上下文切换
+  long involuntary_switches = 0;   // 基准线程被抢占的次数
+  std::vector<std::string> warnings;
+};
+
+// 基准测试计数器的汇总方式：z_rate 为每秒（按计时部分的总耗时），
+// z_average 为每次迭代的平均值
+enum class ZCounterKind { z_rate, z_average };
+// 基准测试的计数器，value 已按 kind 汇总。"bytes" 和 "items" 为每次迭代处理的
+// 字节数和条目数，汇总为每秒速率
+struct ZCounter {
+  std::string name;
+  double value = 0.0;
+  ZCounterKind kind = ZCounterKind::z_average;
+};
+
+// 浸泡测试的一个时间窗口
+struct ZSoakWindow {
+  double t_s = 0.0;       // 窗口结束时距开始的秒数
+  uint64_t count = 0;     // 窗口内的迭代次数
+  double mean_ns = 0.0;
+  uint64_t p50_ns = 0;
+  uint64_t p99_ns = 0;
+  uint64_t max_ns = 0;
+  double rss_kb = 0.0;    // 窗口结束时的常驻内存
+};
+// Mann-Kendall 趋势检验的结果，slope 为 Sen 斜率（每秒的变化量）
+struct ZTrend {
+  double z = 0.0;
+  double p_value = 1.0; // 单侧（递增）检验的 p 值
+  double slope = 0.0;
+  bool increasing = false;
+};
+// 按时长运行的浸泡测试的汇总：总体延迟分布来自固定大小的直方图，
+// 时间序列的窗口数有上限，内存与运行时长无关
+struct ZSoakSummary {
+  double duration_s = 0.0;
+  uint64_t iterations = 0;
+  double mean_ns = 0.0;
+  uint64_t p50_ns = 0;
+  uint64_t p90_ns = 0;
+  uint64_t p99_ns = 0;
+  uint64_t p999_ns = 0;
+  uint64_t max_ns = 0;
+  std::vector<ZSoakWindow> windows;
+  ZTrend rss_trend;
+  ZTrend latency_trend; // 窗口 p50 的趋势
+  std::vector<std::string> warnings;
+};
+
+// 负载测试在一个目标速率下的测量结果，延迟从计划发出时刻算起（已校正协调遗漏）
+struct ZLoadPoint {
+  double target_rate = 0.0;   // 每秒请求数
+  double achieved_rate = 0.0; // 实际完成的每秒请求数
+  uint64_t requests = 0;
+  double mean_ns = 0.0;
+  uint64_t p50_ns = 0;
+  uint64_t p90_ns = 0;
+  uint64_t p99_ns = 0;
+  uint64_t p999_ns = 0;
+  uint64_t max_ns = 0;
+  bool saturated = false;
+};
+// 负载测试的速率扫描，knee_rate 为饱和前的最高目标速率（0 表示第一档即饱和）
+struct ZLoadSummary {
+  std::vector<ZLoadPoint> points;
+  double knee_rate = 0.0;
+  double mean_ns = 0.0;   // 全部速率档所有请求的平均延迟
+  std::string saturation; // 判定饱和的原因，未饱和时为空
+};
+
+// 冷启动基准测试的一个样本：一个新进程中首次运行基准体
+struct ZColdSample {
+  int cpu = -1;                         // 子进程绑定的 CPU，未绑定时为 -1
+  double startup_ns = 0.0;              // 从 fork 到子进程准备运行基准体
+  double first_call_ns = 0.0;           // 首次调用计时部分的耗时
+  double process_ns = 0.0;              // 从 fork 到子进程退出
+  long startup_minor_faults = 0;        // 启动期间的缺页次数
+  long startup_major_faults = 0;
+  long first_call_minor_faults = 0;     // 首次调用期间的缺页次数
+  long first_call_major_faults = 0;
+};
+// 冷启动样本某一项的分布
+struct ZColdMetric {
+  std::string name; // 如 first_call_ns、first_call_minor_faults
+  double mean = 0.0;
+  uint64_t min = 0;
+  uint64_t p50 = 0;
+  uint64_t p90 = 0;
+  uint64_t p99 = 0;
+  uint64_t max = 0;
+};
+// 冷启动基准测试的汇总
+struct ZColdStartSummary {
+  size_t parallel = 1; // 同时运行的子进程数
+  size_t failed = 0;   // 没有返回结果的子进程数
+  std::vector<ZColdSample> samples;
+  std::vector<ZColdMetric> metrics;
+};
+
+// 多线程基准测试在某个线程数下的测量结果
+struct ZScalingPoint {
+  size_t threads = 1;
+  double wall_ms = 0.0;                // 最慢线程的计时部分耗时
+  double throughput = 0.0;             // 所有线程合计的每秒迭代次数
+  double speedup = 1.0;                // 相对单线程吞吐量的倍数
+  double efficiency = 1.0;             // speedup / threads
+  std::vector<double> thread_ms;       // 每个线程的耗时
+};
+
 // ZTestResult是每一个测试的最终状态
 
 class ZTestResult {
@@ -15,20 +148,31 @@ private:
   high_resolution_clock::time_point _end_time;
   ZState _test_state;
   string _error_msg;
-  int _iterations;
+  uint64_t _iterations;
   double _avg_time;
   ZType _test_type;
   std::vector<double> _iterationTimestamps;
+  std::vector<ZTestFailure> _failures;
+  std::optional<ZPropertyInfo> _property;
+  std::optional<ZBenchEnvironment> _environment;
+  std::vector<ZScalingPoint> _scaling;
+  std::vector<ZCounter> _counters;
+  std::optional<ZSoakSummary> _soak;
+  std::optional<ZLoadSummary> _load;
+  std::optional<ZColdStartSummary> _cold_start;
+  double _fixture_time = 0.0; // 共享夹具的构建时间，不计入 _duration
+  bool _cached = false;
 
 public:
   ZTestResult()
       : _test_name("unknown"), _duration(0.0), _test_state(ZState::z_failed),
         _error_msg("") {}
   ZTestResult(string test_name, ZType ztype, double duration, ZState state,
-              string error_msg, int iterations = 1)
+              string error_msg, uint64_t iterations = 1)
       : _test_name(test_name), _duration(duration), _test_state(state),
         _error_msg(error_msg), _iterations(iterations),
-        _avg_time(duration / iterations), _test_type(ztype) {}
+        _avg_time(duration / std::max<uint64_t>(iterations, 1)),
+        _test_type(ztype) {}
   virtual ~ZTestResult() = default; // Add this line
 
   bool operator==(const ZTestResult &other) const {
@@ -41,7 +185,7 @@ public:
   void setResult(const string &name, ZType ztype, ZState state,
                  string error_msg, system_clock::time_point start_time,
                  system_clock::time_point end_time, double used_time,
-                 int iterations = 1) {
+                 uint64_t iterations = 1) {
     _test_name = name;
     _test_type = ztype;
     _test_state = state;
@@ -50,7 +194,17 @@ public:
     _end_time = end_time;
     _duration = used_time;
     _iterations = iterations;
-    _avg_time = used_time / iterations;
+    _avg_time = used_time / std::max<uint64_t>(iterations, 1);
+    _cached = false;
+    _failures.clear();
+    _property.reset();
+    _environment.reset();
+    _scaling.clear();
+    _counters.clear();
+    _soak.reset();
+    _load.reset();
+    _cold_start.reset();
+    _fixture_time = 0.0;
   }
 
   const double &getUsedTime() const { return _duration; }
@@ -59,9 +213,14 @@ public:
 
   const string &getName() const { return _test_name; }
   const double getAverageTime() const { return _avg_time; }
-  const int getIterations() const { return _iterations; }
+  uint64_t getIterations() const { return _iterations; }
   ZState getState() const { return _test_state; }
   ZType getType() const { return _test_type; }
+  /**
+   * @description: 结果是否来自结果缓存（测试未实际执行）
+   */
+  bool isCached() const { return _cached; }
+  void setCached(bool cached) { _cached = cached; }
 
   /**
    * @description: 获取测试结果字符串
@@ -81,6 +240,8 @@ public:
       oss << red << "[  FAILED  ] " << reset;
 
     oss << test_name << " (" << duration_str << ")";
+    if (_cached)
+      oss << " [cached]";
 
     if (!_error_msg.empty()) {
       oss << "\n" << red << "Error: " << reset << _error_msg;
@@ -89,18 +250,106 @@ public:
     return oss.str();
   }
 
+  /**
+   * @description: 获取测试中所有失败的断言（按发生顺序）
+   */
+  const std::vector<ZTestFailure> &getFailures() const { return _failures; }
+  void setFailures(std::vector<ZTestFailure> failures) {
+    _failures = std::move(failures);
+  }
+
+  /**
+   * @description: 性质测试的种子和反例，非性质测试为空
+   */
+  const std::optional<ZPropertyInfo> &getProperty() const { return _property; }
+  void setProperty(ZPropertyInfo info) { _property = std::move(info); }
+
+  /**
+   * @description: 基准测试的运行环境，非基准测试为空
+   */
+  const std::optional<ZBenchEnvironment> &getEnvironment() const {
+    return _environment;
+  }
+  void setEnvironment(ZBenchEnvironment env) { _environment = std::move(env); }
+  /**
+   * @description: 多线程基准测试按线程数的扩展曲线，其它测试为空
+   */
+  const std::vector<ZScalingPoint> &getScaling() const { return _scaling; }
+  void setScaling(std::vector<ZScalingPoint> scaling) {
+    _scaling = std::move(scaling);
+  }
+  /**
+   * @description: 基准测试的吞吐量和自定义计数器
+   */
+  const std::vector<ZCounter> &getCounters() const { return _counters; }
+  void setCounters(std::vector<ZCounter> counters) {
+    _counters = std::move(counters);
+  }
+  /**
+   * @description: 浸泡测试的延迟分布、时间序列和趋势，其它测试为空
+   */
+  const std::optional<ZSoakSummary> &getSoak() const { return _soak; }
+  void setSoak(ZSoakSummary soak) { _soak = std::move(soak); }
+  /**
+   * @description: 负载测试的速率扫描结果，其它测试为空
+   */
+  const std::optional<ZLoadSummary> &getLoad() const { return _load; }
+  void setLoad(ZLoadSummary load) { _load = std::move(load); }
+  /**
+   * @description: 冷启动基准测试的样本和分布，其它测试为空
+   */
+  const std::optional<ZColdStartSummary> &getColdStart() const {
+    return _cold_start;
+  }
+  void setColdStart(ZColdStartSummary cold_start) {
+    _cold_start = std::move(cold_start);
+  }
+
+  /**
+   * @description: 将测试期间构建共享夹具的时间从测试时间中分离出来
+   * @param ms 夹具构建时间（毫秒）
+   */
+  void separateFixtureTime(double ms) {
+    _fixture_time = ms;
+    _duration = std::max(0.0, _duration - ms);
+    _avg_time = _duration / std::max<uint64_t>(_iterations, 1);
+  }
+  double getFixtureTime() const { return _fixture_time; }
+  void setFixtureTime(double ms) { _fixture_time = ms; }
+
   const std::vector<double> &getIterationTimestamps() const {
     return _iterationTimestamps;
   }
-  void setIterationTimestamps(const std::vector<double> &timestamps) {
-    _iterationTimestamps = timestamps;
+  void setIterationTimestamps(std::vector<double> timestamps) {
+    _iterationTimestamps = std::move(timestamps);
+  }
+};
+
+// 结果统计，随结果写入增量维护，报告生成时无需预先遍历
+struct ZResultTally {
+  size_t total = 0;
+  size_t passed = 0;
+  size_t failed = 0;
+  double duration = 0.0;
+
+  void add(const ZTestResult &result, int sign) {
+    total += sign;
+    if (result.getState() == ZState::z_success)
+      passed += sign;
+    else if (result.getState() == ZState::z_failed)
+      failed += sign;
+    duration += sign * result.getUsedTime();
   }
 };
 
 class ZTestResultManager {
 private:
-  unordered_map<string, ZTestResult> _results;
-  mutex _mutex;
+  map<string, ZTestResult> _results; // 有序存储，同一套件的结果连续
+  ZResultTally _summary;
+  map<string, ZResultTally> _suite_tallies;
+  ZFailureClusters _failures;
+  function<void(const ZTestResult &)> _listener;
+  mutable mutex _mutex;
 
 public:
   ZTestResultManager() = default;
@@ -108,17 +357,77 @@ public:
     static ZTestResultManager instance;
     return instance;
   }
+  /**
+   * @description: 获取测试名对应的套件名（第一个'.'之前的部分）
+   */
+  static string suiteOf(const string &name) {
+    size_t dotPos = name.find('.');
+    return (dotPos != string::npos) ? name.substr(0, dotPos) : "Other";
+  }
 
   void addResult(const ZTestResult &result) {
     lock_guard<mutex> lock(_mutex);
+    auto &suite = _suite_tallies[suiteOf(result.getName())];
+    if (auto it = _results.find(result.getName()); it != _results.end()) {
+      _summary.add(it->second, -1);
+      suite.add(it->second, -1);
+      if (it->second.getState() == ZState::z_failed)
+        _failures.remove(it->first, it->second.getErrorMsg());
+    }
     _results[result.getName()] = result;
+    _summary.add(result, 1);
+    suite.add(result, 1);
+    if (result.getState() == ZState::z_failed)
+      _failures.add(result.getName(), result.getErrorMsg());
+    if (_listener)
+      _listener(result);
+  }
+  /**
+   * @description: 设置结果监听器，每个结果写入时在持锁状态下按写入顺序调用
+   * @param listener 监听函数，传入空函数时移除监听
+   */
+  void setResultListener(function<void(const ZTestResult &)> listener) {
+    lock_guard<mutex> lock(_mutex);
+    _listener = std::move(listener);
   }
 
   const ZTestResult &getResult(const string &name) const {
     return _results.at(name);
   }
 
-  const unordered_map<string, ZTestResult> &getResults() const {
-    return _results;
+  const map<string, ZTestResult> &getResults() const { return _results; }
+  /**
+   * @description: 持锁按名称顺序遍历所有结果，避免复制整个结果表
+   * @param visitor 对每个结果调用的函数
+   * @param prologue 遍历前以同一把锁下的总统计和套件统计调用，可为空
+   */
+  void forEachResult(
+      const function<void(const ZTestResult &)> &visitor,
+      const function<void(const ZResultTally &,
+                          const map<string, ZResultTally> &)> &prologue =
+          nullptr) const {
+    lock_guard<mutex> lock(_mutex);
+    if (prologue)
+      prologue(_summary, _suite_tallies);
+    for (const auto &[name, result] : _results)
+      visitor(result);
+  }
+  ZResultTally getSummary() const {
+    lock_guard<mutex> lock(_mutex);
+    return _summary;
   }
-};
\ No newline at end of file
+  /**
+   * @description: 获取按错误特征分组的失败，按数量降序
+   */
+  vector<ZFailureBucket> getFailureBuckets() const {
+    lock_guard<mutex> lock(_mutex);
+    return _failures.buckets();
+  }
+  /**
+   * @description: 获取各套件的统计副本（按套件数量计，开销很小）
+   */
+  map<string, ZResultTally> getSuiteTallies() const {
+    lock_guard<mutex> lock(_mutex);
+    return _suite_tallies;
+  }
+};
@@ -0,0 +1,215 @@
+#pragma once
+#include "ztest_base.hpp"
+#include "ztest_logger.hpp"
+#include "ztest_thread.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+// 依赖感知的调度：按 dependsOn 构建有向无环图，入度为0且资源足够的测试
+// 并行地提交到线程池；前置测试失败时其所有后继立即判为失败而不再运行。
+// 资源容量取所有声明中的最大值，互斥锁占用全部容量。
+class ZTestScheduler {
+public:
+  using Runner = function<ZState(const shared_ptr<ZTestBase> &)>;
+  using Skipper =
+      function<void(const shared_ptr<ZTestBase> &, const string &reason)>;
+  // 查询图外测试（如已运行的 unsafe 测试或命中缓存的测试）的结果
+  using Lookup = function<optional<ZState>(const string &name)>;
+
+  explicit ZTestScheduler(ZThreadPool &pool) : _pool(pool) {}
+  /**
+   * @description: 按依赖关系和资源限制运行一组测试，返回时所有测试都已有结果
+   * @param tests 要调度的测试
+   * @param runner 运行并提交单个测试，返回最终状态
+   * @param skipper 因依赖失败而不运行时提交失败结果
+   * @param lookup 依赖不在本组中时查询其结果
+   */
+  void run(const vector<shared_ptr<ZTestBase>> &tests, const Runner &runner,
+           const Skipper &skipper, const Lookup &lookup) {
+    _tests = tests;
+    _runner = runner;
+    _skipper = skipper;
+    build(lookup);
+
+    vector<future<void>> futures;
+    {
+      unique_lock<mutex> lock(_mutex);
+      while (_remaining > 0) {
+        for (auto it = _ready.begin(); it != _ready.end();) {
+          if (!tryAcquire(*it)) {
+            ++it;
+            continue;
+          }
+          const size_t index = *it;
+          it = _ready.erase(it);
+          _nodes[index].status = Status::z_running;
+          ++_running;
+          futures.push_back(_pool.enqueue([this, index] { execute(index); }));
+        }
+        if (_remaining == 0)
+          break;
+        if (_running == 0 && _ready.empty()) {
+          // 没有可运行也没有正在运行的测试：剩余的测试处于依赖环中
+          vector<size_t> stuck;
+          for (size_t i = 0; i < _nodes.size(); ++i)
+            if (_nodes[i].status == Status::z_waiting)
+              stuck.push_back(i);
+          for (size_t i : stuck)
+            if (_nodes[i].status == Status::z_waiting)
+              fail(i, "Dependency cycle involving " + _tests[i]->getName(),
+                 _pending_skips);
+          continue;
+        }
+        _changed.wait(lock);
+      }
+    }
+    flushSkips();
+    for (auto &future : futures)
+      _pool.join(future);
+    flushSkips();
+  }
+
+private:
+  enum class Status { z_waiting, z_running, z_done };
+  struct Node {
+    size_t waiting_on = 0; // 尚未完成的图内依赖数
+    vector<size_t> dependents;
+    vector<pair<string, size_t>> claims; // 资源名和占用单位
+    Status status = Status::z_waiting;
+  };
+
+  void build(const Lookup &lookup) {
+    _nodes.assign(_tests.size(), Node());
+    _ready.clear();
+    _in_use.clear();
+    _capacity.clear();
+    _running = 0;
+    _remaining = _tests.size();
+
+    unordered_map<string, size_t> index;
+    for (size_t i = 0; i < _tests.size(); ++i)
+      index.emplace(_tests[i]->getName(), i);
+    for (const auto &test : _tests)
+      for (const auto &claim : test->getResources())
+        _capacity[claim.name] =
+            max(_capacity[claim.name], max<size_t>(claim.capacity, 1));
+
+    size_t edges = 0;
+    vector<pair<size_t, string>> rejected;
+    for (size_t i = 0; i < _tests.size(); ++i) {
+      Node &node = _nodes[i];
+      for (const auto &claim : _tests[i]->getResources())
+        node.claims.emplace_back(claim.name,
+                                 claim.exclusive ? _capacity[claim.name] : 1);
+      for (const auto &dep : _tests[i]->getDependencies()) {
+        if (auto it = index.find(dep); it != index.end()) {
+          _nodes[it->second].dependents.push_back(i);
+          ++node.waiting_on;
+          ++edges;
+          continue;
+        }
+        const optional<ZState> state = lookup(dep);
+        if (!state)
+          rejected.emplace_back(i, "Unknown dependency " + dep);
+        else if (*state != ZState::z_success)
+          rejected.emplace_back(i, "Dependency " + dep + " failed");
+      }
+    }
+    if (edges > 0 || !_capacity.empty())
+      logger.info("[Scheduler] " + to_string(_tests.size()) + " tests, " +
+                  to_string(edges) + " dependencies, " +
+                  to_string(_capacity.size()) + " shared resources");
+
+    for (auto &[i, reason] : rejected)
+      if (_nodes[i].status == Status::z_waiting)
+        fail(i, reason, _pending_skips);
+    for (size_t i = 0; i < _nodes.size(); ++i)
+      if (_nodes[i].status == Status::z_waiting && _nodes[i].waiting_on == 0)
+        _ready.push_back(i);
+  }
+
+  bool tryAcquire(size_t index) {
+    for (const auto &[name, units] : _nodes[index].claims)
+      if (_in_use[name] + units > _capacity[name])
+        return false;
+    for (const auto &[name, units] : _nodes[index].claims)
+      _in_use[name] += units;
+    return true;
+  }
+
+  void execute(size_t index) {
+    ZState state = ZState::z_failed;
+    try {
+      state = _runner(_tests[index]);
+    } catch (const exception &e) {
+      logger.error("[Scheduler] " + _tests[index]->getName() + ": " + e.what());
+    }
+    vector<pair<size_t, string>> skips;
+    {
+      lock_guard<mutex> lock(_mutex);
+      for (const auto &[name, units] : _nodes[index].claims)
+        _in_use[name] -= units;
+      _nodes[index].status = Status::z_done;
+      --_running;
+      --_remaining;
+      for (size_t next : _nodes[index].dependents) {
+        if (_nodes[next].status != Status::z_waiting)
+          continue;
+        if (state != ZState::z_success)
+          fail(next, "Dependency " + _tests[index]->getName() + " failed",
+               skips);
+        else if (--_nodes[next].waiting_on == 0)
+          _ready.push_back(next);
+      }
+    }
+    _changed.notify_one();
+    for (auto &[i, reason] : skips)
+      _skipper(_tests[i], reason);
+  }
+  /**
+   * @description: 将测试及其所有仍在等待的后继标记为失败，调用方持锁
+   */
+  void fail(size_t index, const string &reason,
+            vector<pair<size_t, string>> &skips) {
+    _nodes[index].status = Status::z_done;
+    --_remaining;
+    _ready.erase(remove(_ready.begin(), _ready.end(), index), _ready.end());
+    skips.emplace_back(index, reason);
+    for (size_t next : _nodes[index].dependents)
+      if (_nodes[next].status == Status::z_waiting)
+        fail(next, "Dependency " + _tests[index]->getName() + " failed", skips);
+  }
+
+  void flushSkips() {
+    vector<pair<size_t, string>> skips;
+    {
+      lock_guard<mutex> lock(_mutex);
+      skips.swap(_pending_skips);
+    }
+    for (auto &[i, reason] : skips)
+      _skipper(_tests[i], reason);
+  }
+
+  ZThreadPool &_pool;
+  vector<shared_ptr<ZTestBase>> _tests;
+  Runner _runner;
+  Skipper _skipper;
+  vector<Node> _nodes;
+  deque<size_t> _ready;
+  unordered_map<string, size_t> _capacity;
+  unordered_map<string, size_t> _in_use;
+  vector<pair<size_t, string>> _pending_skips; // 调度线程上判定失败的测试
+  size_t _running = 0;
+  size_t _remaining = 0;
+  mutex _mutex;
+  condition_variable _changed;
+};
@@ -0,0 +1,305 @@
+#pragma once
+#include "ztest_assert.hpp"
+#include "ztest_compare.hpp"
+#include "ztest_logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+// 快照（golden file）测试：将输出与快照文件逐字节比较。
+// 未压缩的快照直接 mmap 后用 memcmp 比较；以 .gz 结尾的快照先解压再比较。
+// 不一致时按块定位第一个差异，报告字节偏移、行列号和两边对应的行。
+// 以 --update-snapshots 运行时改为（重新）写入快照，断言总是通过。
+// 快照文件不在结果缓存的键中，使用快照的测试不会被缓存。
+
+// 只读映射的快照文件，空文件不映射
+class ZMappedFile {
+public:
+  explicit ZMappedFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      throw std::runtime_error("Failed to open snapshot " + path + ": " +
+                               std::strerror(errno));
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Failed to stat snapshot: " + path);
+    }
+    _size = static_cast<size_t>(st.st_size);
+    if (_size > 0) {
+      void *addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Failed to mmap snapshot: " + path);
+      }
+      _data = static_cast<const uint8_t *>(addr);
+      ::madvise(addr, _size, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+  }
+  ZMappedFile(const ZMappedFile &) = delete;
+  ZMappedFile &operator=(const ZMappedFile &) = delete;
+  ~ZMappedFile() {
+    if (_data)
+      ::munmap(const_cast<uint8_t *>(_data), _size);
+  }
+
+  std::span<const uint8_t> bytes() const { return {_data, _size}; }
+
+private:
+  const uint8_t *_data = nullptr;
+  size_t _size = 0;
+};
+
+class ZSnapshot {
+public:
+  static constexpr size_t kChunkSize = 64 * 1024;
+  static constexpr size_t kMaxLineShown = 160;
+
+  static void setUpdate(bool update) { updateRef() = update; }
+  static bool isUpdating() { return updateRef(); }
+  /**
+   * @description: 设置快照目录，相对路径的快照名相对于该目录
+   */
+  static void setDirectory(const std::string &dir) {
+    std::lock_guard<std::mutex> lock(mutexRef());
+    directoryRef() = dir;
+  }
+  static std::string getDirectory() {
+    std::lock_guard<std::mutex> lock(mutexRef());
+    return directoryRef();
+  }
+  /**
+   * @description: 将输出与快照比较，更新模式下改为写入快照
+   * @param name 快照文件名，以 .gz 结尾时按 gzip 压缩存储
+   * @param actual 实际输出，字符串或任意连续序列
+   * @return 比较结果，失败时附带差异描述
+   */
+  template <typename T>
+  static ZCompareReport compare(const std::string &name, const T &actual) {
+    if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      std::string_view text = actual;
+      return compareBytes(name, {reinterpret_cast<const uint8_t *>(text.data()),
+                                 text.size()});
+    } else {
+      auto bytes = std::as_bytes(std::span(actual));
+      return compareBytes(name, {reinterpret_cast<const uint8_t *>(bytes.data()),
+                                 bytes.size()});
+    }
+  }
+
+  static ZCompareReport compareBytes(const std::string &name,
+                                     std::span<const uint8_t> actual) {
+    const std::string path = resolve(name);
+    ZAssertBuffer::current().markOwnerUncacheable();
+    ZCompareReport report;
+    report.actual_size = actual.size();
+    if (isUpdating()) {
+      write(path, actual);
+      report.expected_size = actual.size();
+      logger.info("Updated snapshot " + path + " (" +
+                  std::to_string(actual.size()) + " bytes)");
+      return report;
+    }
+    if (!std::filesystem::exists(path)) {
+      report.expected = "snapshot " + path;
+      report.actual = "snapshot file is missing; run with --update-snapshots "
+                      "to create it";
+      report.mismatches = 1;
+      return report;
+    }
+    if (compressed(path)) {
+      std::vector<uint8_t> expected = inflate(path);
+      diff(path, expected, actual, report);
+    } else {
+      ZMappedFile expected(path);
+      diff(path, expected.bytes(), actual, report);
+    }
+    return report;
+  }
+
+private:
+  static std::atomic<bool> &updateRef() {
+    static std::atomic<bool> update{false};
+    return update;
+  }
+  static std::mutex &mutexRef() {
+    static std::mutex mutex;
+    return mutex;
+  }
+  static std::string &directoryRef() {
+    static std::string directory = "snapshots";
+    return directory;
+  }
+
+  static std::string resolve(const std::string &name) {
+    if (std::filesystem::path(name).is_absolute())
+      return name;
+    return (std::filesystem::path(getDirectory()) / name).string();
+  }
+
+  static bool compressed(const std::string &path) {
+    return path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0;
+  }
+  /**
+   * @description: 比较快照和输出；全等时只有一次 memcmp，否则按块定位首个差异
+   */
+  static void diff(const std::string &path, std::span<const uint8_t> expected,
+                   std::span<const uint8_t> actual, ZCompareReport &report) {
+    report.expected_size = expected.size();
+    const size_t common = std::min(expected.size(), actual.size());
+    if (expected.size() == actual.size() &&
+        (common == 0 ||
+         std::memcmp(expected.data(), actual.data(), common) == 0))
+      return;
+
+    size_t first = common; // 大小不同且公共部分相同时，差异从较短一方的末尾开始
+    size_t chunks = 0;
+    for (size_t offset = 0; offset < common; offset += kChunkSize) {
+      const size_t length = std::min(kChunkSize, common - offset);
+      if (std::memcmp(expected.data() + offset, actual.data() + offset,
+                      length) == 0)
+        continue;
+      ++chunks;
+      if (first == common)
+        first = offset + (std::mismatch(expected.begin() + offset,
+                                        expected.begin() + offset + length,
+                                        actual.begin() + offset)
+                              .first -
+                          (expected.begin() + offset));
+    }
+    if (expected.size() != actual.size())
+      chunks += (std::max(expected.size(), actual.size()) - common +
+                 kChunkSize - 1) /
+                kChunkSize;
+
+    const size_t line_start = lineStart(expected, first);
+    const size_t line = 1 + std::count(expected.begin(),
+                                       expected.begin() + line_start, '\n');
+    report.mismatches = std::max<size_t>(chunks, 1);
+    report.worst_index = first;
+    report.expected = "snapshot " + path + " (" +
+                      std::to_string(expected.size()) + " bytes), line " +
+                      std::to_string(line) + ": " +
+                      lineAt(expected, line_start);
+    report.actual = "differs at byte " + std::to_string(first) + " (line " +
+                    std::to_string(line) + ", column " +
+                    std::to_string(first - line_start + 1) + "), " +
+                    std::to_string(chunks) + " of " +
+                    std::to_string((std::max(expected.size(), actual.size()) +
+                                    kChunkSize - 1) /
+                                   kChunkSize) +
+                    " chunks differ, " + std::to_string(actual.size()) +
+                    " bytes: " + lineAt(actual, lineStart(actual, first));
+  }
+
+  static size_t lineStart(std::span<const uint8_t> data, size_t offset) {
+    offset = std::min(offset, data.size());
+    while (offset > 0 && data[offset - 1] != '\n')
+      --offset;
+    return offset;
+  }
+
+  static std::string lineAt(std::span<const uint8_t> data, size_t start) {
+    if (start >= data.size())
+      return "<end of file>";
+    size_t end = start;
+    while (end < data.size() && data[end] != '\n' &&
+           end - start < kMaxLineShown)
+      ++end;
+    std::string line;
+    for (size_t i = start; i < end; ++i) {
+      const uint8_t c = data[i];
+      if (c >= 0x20 && c < 0x7f)
+        line += static_cast<char>(c);
+      else {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\x%02x", c);
+        line += buf;
+      }
+    }
+    if (end < data.size() && data[end] != '\n')
+      line += "...";
+    return "\"" + line + "\"";
+  }
+
+  static std::vector<uint8_t> inflate(const std::string &path) {
+    gzFile file = ::gzopen(path.c_str(), "rb");
+    if (!file)
+      throw std::runtime_error("Failed to open compressed snapshot: " + path);
+    ::gzbuffer(file, 1 << 17);
+    std::vector<uint8_t> out;
+    size_t used = 0;
+    for (;;) {
+      out.resize(used + kChunkSize);
+      int read = ::gzread(file, out.data() + used, kChunkSize);
+      if (read < 0) {
+        ::gzclose(file);
+        throw std::runtime_error("Corrupt compressed snapshot: " + path);
+      }
+      used += static_cast<size_t>(read);
+      if (read == 0)
+        break;
+    }
+    ::gzclose(file);
+    out.resize(used);
+    return out;
+  }
+  /**
+   * @description: 原子地写入快照（先写临时文件再重命名）
+   */
+  static void write(const std::string &path, std::span<const uint8_t> data) {
+    std::error_code ec;
+    std::filesystem::create_directories(
+        std::filesystem::path(path).parent_path(), ec);
+    const std::string tmp = path + ".tmp";
+    if (compressed(path)) {
+      gzFile file = ::gzopen(tmp.c_str(), "wb6");
+      bool ok = file != nullptr;
+      for (size_t offset = 0; ok && offset < data.size(); offset += kChunkSize) {
+        const size_t length = std::min(kChunkSize, data.size() - offset);
+        ok = ::gzwrite(file, data.data() + offset,
+                       static_cast<unsigned>(length)) ==
+             static_cast<int>(length);
+      }
+      if (file && ::gzclose(file) != Z_OK)
+        ok = false;
+      if (!ok)
+        throw std::runtime_error("Failed to write compressed snapshot: " + path);
+    } else {
+      int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                      0644);
+      if (fd < 0)
+        throw std::runtime_error("Failed to create snapshot " + path + ": " +
+                                 std::strerror(errno));
+      size_t written = 0;
+      while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR)
+          continue;
+        if (n <= 0) {
+          ::close(fd);
+          throw std::runtime_error("Failed to write snapshot: " + path);
+        }
+        written += static_cast<size_t>(n);
+      }
+      ::close(fd);
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec)
+      throw std::runtime_error("Failed to replace snapshot " + path + ": " +
+                               ec.message());
+  }
+};
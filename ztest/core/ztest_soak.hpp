@@ -0,0 +1,184 @@
+#pragma once
+#include "ztest_histogram.hpp"
+#include "ztest_result.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <vector>
+// 趋势检验：Mann-Kendall 检验序列是否单调变化（对分布无假设，对离群值稳健），
+// Sen 斜率估计变化速度。用于发现内存泄漏、碎片化导致的 RSS 持续增长和延迟漂移。
+class ZTrendTest {
+public:
+  /**
+   * @description: 对等间隔采样的序列做 Mann-Kendall 检验
+   * @param t 采样时间（秒）
+   * @param y 采样值
+   * @return z 统计量、递增的单侧 p 值和 Sen 斜率（每秒）；少于 kMinSamples 个点时 p 为1
+   */
+  static ZTrend mannKendall(const std::vector<double> &t,
+                            const std::vector<double> &y) {
+    ZTrend trend;
+    const size_t n = y.size();
+    if (n < kMinSamples || t.size() != n)
+      return trend;
+    long long s = 0;
+    std::vector<double> slopes;
+    slopes.reserve(n * (n - 1) / 2);
+    for (size_t i = 0; i + 1 < n; ++i) {
+      for (size_t j = i + 1; j < n; ++j) {
+        s += (y[j] > y[i]) - (y[j] < y[i]);
+        if (t[j] > t[i])
+          slopes.push_back((y[j] - y[i]) / (t[j] - t[i]));
+      }
+    }
+    // 方差按相同值的组做校正
+    std::vector<double> sorted = y;
+    std::sort(sorted.begin(), sorted.end());
+    double variance = n * (n - 1.0) * (2.0 * n + 5.0);
+    for (size_t i = 0; i < n;) {
+      size_t j = i;
+      while (j < n && sorted[j] == sorted[i])
+        ++j;
+      const double ties = static_cast<double>(j - i);
+      variance -= ties * (ties - 1.0) * (2.0 * ties + 5.0);
+      i = j;
+    }
+    variance /= 18.0;
+    if (variance > 0) {
+      if (s > 0)
+        trend.z = (s - 1) / std::sqrt(variance);
+      else if (s < 0)
+        trend.z = (s + 1) / std::sqrt(variance);
+    }
+    trend.p_value = 0.5 * std::erfc(trend.z / std::sqrt(2.0));
+    if (!slopes.empty()) {
+      auto mid = slopes.begin() + slopes.size() / 2;
+      std::nth_element(slopes.begin(), mid, slopes.end());
+      trend.slope = *mid;
+    }
+    trend.increasing = trend.p_value < kAlpha && trend.slope > 0;
+    return trend;
+  }
+
+  static constexpr size_t kMinSamples = 8;
+  static constexpr double kAlpha = 0.01;
+};
+
+// ZSoakRecorder 记录浸泡测试的每次迭代：总体分布和当前窗口各用一个直方图，
+// 每个窗口结束时记录窗口统计和 RSS。窗口长度为总时长的 1/kMaxWindows，
+// 因此内存不随运行时长增长。
+class ZSoakRecorder {
+public:
+  static constexpr size_t kMaxWindows = 240;
+
+  explicit ZSoakRecorder(double duration_s)
+      : _window_s(std::max(duration_s / kMaxWindows, 0.01)) {
+    _summary.windows.reserve(kMaxWindows + 1);
+    _start = _window_start = std::chrono::steady_clock::now();
+  }
+  /**
+   * @description: 记录一次迭代
+   * @param ns 迭代计时部分的耗时（纳秒）
+   * @param now 记录时刻
+   */
+  void record(uint64_t ns, std::chrono::steady_clock::time_point now) {
+    _total.record(ns);
+    _window.record(ns);
+    if (seconds(now - _window_start) >= _window_s)
+      closeWindow(now);
+  }
+  /**
+   * @description: 结束记录，计算分布和趋势
+   * @return 汇总结果
+   */
+  ZSoakSummary finish() {
+    const auto now = std::chrono::steady_clock::now();
+    if (_window.count() > 0)
+      closeWindow(now);
+    _summary.duration_s = seconds(now - _start);
+    _summary.iterations = _total.count();
+    _summary.mean_ns = _total.mean();
+    _summary.p50_ns = _total.percentile(50);
+    _summary.p90_ns = _total.percentile(90);
+    _summary.p99_ns = _total.percentile(99);
+    _summary.p999_ns = _total.percentile(99.9);
+    _summary.max_ns = _total.max();
+
+    std::vector<double> t, rss, latency;
+    for (const auto &window : _summary.windows) {
+      t.push_back(window.t_s);
+      rss.push_back(window.rss_kb);
+      latency.push_back(static_cast<double>(window.p50_ns));
+    }
+    _summary.rss_trend = ZTrendTest::mannKendall(t, rss);
+    _summary.latency_trend = ZTrendTest::mannKendall(t, latency);
+    // 样本多时极小的漂移也会显著，只报告整个运行期间变化足够大的趋势：
+    // RSS 至少增长 1MiB 且超过初始值的1%，延迟至少增长中位数的5%
+    const double span = t.empty() ? 0.0 : t.back() - t.front();
+    if (!rss.empty() && _summary.rss_trend.slope * span <
+                            std::max(1024.0, 0.01 * rss.front()))
+      _summary.rss_trend.increasing = false;
+    if (_summary.latency_trend.slope * span < 0.05 * _summary.p50_ns)
+      _summary.latency_trend.increasing = false;
+    if (_summary.rss_trend.increasing)
+      _summary.warnings.push_back(
+          "RSS grows monotonically: " +
+          format(_summary.rss_trend.slope * 3600.0 / 1024.0) +
+          " MiB/h (Mann-Kendall p=" + format(_summary.rss_trend.p_value, "%.2g") +
+          ")");
+    if (_summary.latency_trend.increasing)
+      _summary.warnings.push_back(
+          "Median latency drifts upward: " +
+          format(_summary.latency_trend.slope * 3600.0 / 1000.0) +
+          " us/h (Mann-Kendall p=" +
+          format(_summary.latency_trend.p_value, "%.2g") + ")");
+    return std::move(_summary);
+  }
+  const ZHdrHistogram &histogram() const { return _total; }
+
+  /**
+   * @description: 当前进程的常驻内存（KB）
+   */
+  static double residentKb() {
+    FILE *statm = std::fopen("/proc/self/statm", "r");
+    if (!statm)
+      return 0.0;
+    long size = 0, resident = 0;
+    const int read = std::fscanf(statm, "%ld %ld", &size, &resident);
+    std::fclose(statm);
+    return read == 2 ? resident * (sysconf(_SC_PAGESIZE) / 1024.0) : 0.0;
+  }
+
+private:
+  void closeWindow(std::chrono::steady_clock::time_point now) {
+    ZSoakWindow window;
+    window.t_s = seconds(now - _start);
+    window.count = _window.count();
+    window.mean_ns = _window.mean();
+    window.p50_ns = _window.percentile(50);
+    window.p99_ns = _window.percentile(99);
+    window.max_ns = _window.max();
+    window.rss_kb = residentKb();
+    _summary.windows.push_back(window);
+    _window.reset();
+    _window_start = now;
+  }
+  static double seconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+  }
+  static std::string format(double value, const char *fmt = "%.2f") {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), fmt, value);
+    return buf;
+  }
+
+  double _window_s;
+  ZHdrHistogram _total;
+  ZHdrHistogram _window;
+  ZSoakSummary _summary;
+  std::chrono::steady_clock::time_point _start;
+  std::chrono::steady_clock::time_point _window_start;
+};
@@ -0,0 +1,401 @@
+#pragma once
+#include "ztest_logger.hpp"
+#include "ztest_result.hpp"
+#include "ztest_utils.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+// ZResultStream 在测试运行期间把每个结果以一行JSON追加写入流文件（JSON-lines），
+// 每行在结果产生时立即写入内核，进程中途崩溃时已完成的结果仍可通过 replay
+// 恢复并重新生成报告；fdatasync（防止断电丢失）按间隔合并。
+// 第一行为流头 {"ztest_stream":版本}，之后每行一个结果。
+class ZResultStream {
+public:
+  static constexpr int kVersion = 1;
+
+  static ZResultStream &instance() {
+    static ZResultStream stream;
+    return stream;
+  }
+  /**
+   * @description: 打开流文件并开始记录写入 ZTestResultManager 的结果
+   * @param path 流文件路径，已存在时被截断
+   * @return 打开成功返回true
+   */
+  bool open(const std::string &path) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      closeLocked();
+      _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND |
+                                     O_CLOEXEC,
+                   0644);
+      if (_fd < 0) {
+        logger.error("Failed to open result stream " + path + ": " +
+                     std::strerror(errno));
+        return false;
+      }
+      _path = path;
+      writeLocked(json{{"ztest_stream", kVersion}}.dump() + "\n");
+      syncLocked();
+    }
+    // GUI 初始化时写入的 z_unknown 占位结果不是测试结果，不写入流
+    ZTestResultManager::getInstance().setResultListener(
+        [this](const ZTestResult &result) {
+          if (result.getState() != ZState::z_unknown)
+            append(result);
+        });
+    logger.info("Streaming results to: " + path);
+    return true;
+  }
+  /**
+   * @description: 写出剩余缓冲、同步到磁盘并关闭流文件
+   */
+  void close() {
+    ZTestResultManager::getInstance().setResultListener(nullptr);
+    std::lock_guard<std::mutex> lock(_mutex);
+    closeLocked();
+  }
+  bool isOpen() const { return _fd >= 0; }
+  /**
+   * @description: 立即同步到磁盘
+   */
+  void sync() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_fd >= 0)
+      syncLocked();
+  }
+  /**
+   * @description: 设置两次 fdatasync 之间的最短间隔
+   */
+  void setSyncInterval(std::chrono::milliseconds sync_interval) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sync_interval = sync_interval;
+  }
+  /**
+   * @description: 追加一个结果并立即写入文件，距上次同步超过间隔时同步到磁盘
+   * @param result 测试结果
+   */
+  void append(const ZTestResult &result) {
+    json record = {{"name", result.getName()},
+                   {"type", static_cast<int>(result.getType())},
+                   {"state", static_cast<int>(result.getState())},
+                   {"duration", result.getUsedTime()},
+                   {"iterations", result.getIterations()},
+                   {"cached", result.isCached()},
+                   {"error", result.getErrorMsg()},
+                   {"ts", duration_cast<milliseconds>(
+                              system_clock::now().time_since_epoch())
+                              .count()}};
+    if (!result.getFailures().empty()) {
+      json failures = json::array();
+      for (const auto &failure : result.getFailures())
+        failures.push_back({{"file", failure.file},
+                            {"line", failure.line},
+                            {"expression", failure.expression},
+                            {"message", failure.message},
+                            {"fatal", failure.fatal}});
+      record["failures"] = std::move(failures);
+    }
+    if (result.getFixtureTime() > 0)
+      record["fixture_ms"] = result.getFixtureTime();
+    if (const auto &property = result.getProperty())
+      record["property"] = {{"seed", property->seed},
+                            {"cases", property->cases},
+                            {"shrinks", property->shrinks},
+                            {"original", property->original},
+                            {"counterexample", property->counterexample}};
+    if (const auto &env = result.getEnvironment())
+      record["environment"] = {{"cpu", env->cpu},
+                               {"governor", env->governor},
+                               {"turbo", env->turbo},
+                               {"smt_siblings", env->smt_siblings},
+                               {"load_before", env->load_before},
+                               {"load_after", env->load_after},
+                               {"throttle_events", env->throttle_events},
+                               {"voluntary_switches", env->voluntary_switches},
+                               {"involuntary_switches",
+                                env->involuntary_switches},
+                               {"warnings", env->warnings}};
+    if (!result.getCounters().empty()) {
+      json counters = json::array();
+      for (const auto &counter : result.getCounters())
+        counters.push_back({{"name", counter.name},
+                            {"value", counter.value},
+                            {"kind", static_cast<int>(counter.kind)}});
+      record["counters"] = std::move(counters);
+    }
+    if (const auto &cold = result.getColdStart()) {
+      // 样本按 [cpu, startup_ns, first_call_ns, process_ns, 启动缺页(次/主),
+      // 首次调用缺页(次/主)] 紧凑保存，分布按 [name, mean, min, p50, p90, p99, max]
+      json samples = json::array(), metrics = json::array();
+      for (const auto &c : cold->samples)
+        samples.push_back({c.cpu, c.startup_ns, c.first_call_ns, c.process_ns,
+                           c.startup_minor_faults, c.startup_major_faults,
+                           c.first_call_minor_faults,
+                           c.first_call_major_faults});
+      for (const auto &m : cold->metrics)
+        metrics.push_back({m.name, m.mean, m.min, m.p50, m.p90, m.p99, m.max});
+      record["cold_start"] = {{"parallel", cold->parallel},
+                              {"failed", cold->failed},
+                              {"metrics", std::move(metrics)},
+                              {"samples", std::move(samples)}};
+    }
+    if (const auto &load = result.getLoad()) {
+      json points = json::array();
+      for (const auto &p : load->points)
+        points.push_back({{"target_rate", p.target_rate},
+                          {"achieved_rate", p.achieved_rate},
+                          {"requests", p.requests},
+                          {"mean_ns", p.mean_ns},
+                          {"p50_ns", p.p50_ns},
+                          {"p90_ns", p.p90_ns},
+                          {"p99_ns", p.p99_ns},
+                          {"p999_ns", p.p999_ns},
+                          {"max_ns", p.max_ns},
+                          {"saturated", p.saturated}});
+      record["load"] = {{"knee_rate", load->knee_rate},
+                        {"mean_ns", load->mean_ns},
+                        {"saturation", load->saturation},
+                        {"points", std::move(points)}};
+    }
+    if (const auto &soak = result.getSoak()) {
+      const auto trend = [](const ZTrend &t) {
+        return json{{"z", t.z},
+                    {"p_value", t.p_value},
+                    {"slope", t.slope},
+                    {"increasing", t.increasing}};
+      };
+      json windows = json::array();
+      for (const auto &w : soak->windows)
+        windows.push_back({w.t_s, w.count, w.mean_ns, w.p50_ns, w.p99_ns,
+                           w.max_ns, w.rss_kb});
+      record["soak"] = {{"duration_s", soak->duration_s},
+                        {"iterations", soak->iterations},
+                        {"mean_ns", soak->mean_ns},
+                        {"p50_ns", soak->p50_ns},
+                        {"p90_ns", soak->p90_ns},
+                        {"p99_ns", soak->p99_ns},
+                        {"p999_ns", soak->p999_ns},
+                        {"max_ns", soak->max_ns},
+                        {"rss_trend", trend(soak->rss_trend)},
+                        {"latency_trend", trend(soak->latency_trend)},
+                        {"warnings", soak->warnings},
+                        {"windows", std::move(windows)}};
+    }
+    if (!result.getScaling().empty()) {
+      json scaling = json::array();
+      for (const auto &point : result.getScaling())
+        scaling.push_back({{"threads", point.threads},
+                           {"wall_ms", point.wall_ms},
+                           {"throughput", point.throughput},
+                           {"speedup", point.speedup},
+                           {"efficiency", point.efficiency},
+                           {"thread_ms", point.thread_ms}});
+      record["scaling"] = std::move(scaling);
+    }
+    std::string line = record.dump(-1, ' ', false,
+                                   json::error_handler_t::replace);
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_fd < 0)
+      return;
+    line += '\n';
+    writeLocked(line);
+    if (steady_clock::now() - _last_sync >= _sync_interval)
+      syncLocked();
+  }
+  /**
+   * @description: 从流文件（可以是中途崩溃留下的不完整文件）恢复结果
+   *               到 ZTestResultManager，末尾未写完的行会被忽略
+   * @param path 流文件路径
+   * @return 恢复的结果数量
+   */
+  static size_t replay(const std::string &path) {
+    std::ifstream file(path);
+    if (!file)
+      throw std::runtime_error("Failed to open result stream: " + path);
+    size_t count = 0, line_no = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+      ++line_no;
+      if (line.empty())
+        continue;
+      json record = json::parse(line, nullptr, false);
+      if (record.is_discarded()) {
+        logger.warning("Stopping replay at truncated line " +
+                       std::to_string(line_no) + " of " + path);
+        break;
+      }
+      if (record.contains("ztest_stream")) {
+        if (record["ztest_stream"].get<int>() > kVersion)
+          throw std::runtime_error("Unsupported result stream version in " +
+                                   path);
+        continue;
+      }
+      ZTestResult result;
+      const auto now = system_clock::now();
+      result.setResult(record.at("name").get<std::string>(),
+                       static_cast<ZType>(record.at("type").get<int>()),
+                       static_cast<ZState>(record.at("state").get<int>()),
+                       record.value("error", ""), now, now,
+                       record.at("duration").get<double>(),
+                       record.value("iterations", uint64_t(1)));
+      result.setCached(record.value("cached", false));
+      if (auto it = record.find("failures"); it != record.end()) {
+        std::vector<ZTestFailure> failures;
+        for (const auto &failure : *it)
+          failures.push_back({failure.value("file", ""),
+                              failure.value("line", 0),
+                              failure.value("expression", ""),
+                              failure.value("message", ""),
+                              failure.value("fatal", false)});
+        result.setFailures(std::move(failures));
+      }
+      if (auto it = record.find("property"); it != record.end())
+        result.setProperty({it->value("seed", uint64_t(0)),
+                            it->value("cases", size_t(0)),
+                            it->value("shrinks", size_t(0)),
+                            it->value("original", ""),
+                            it->value("counterexample", "")});
+      if (auto it = record.find("environment"); it != record.end()) {
+        ZBenchEnvironment env;
+        env.cpu = it->value("cpu", -1);
+        env.governor = it->value("governor", "");
+        env.turbo = it->value("turbo", "");
+        env.smt_siblings = it->value("smt_siblings", "");
+        env.load_before = it->value("load_before", 0.0);
+        env.load_after = it->value("load_after", 0.0);
+        env.throttle_events = it->value("throttle_events", uint64_t(0));
+        env.voluntary_switches = it->value("voluntary_switches", 0L);
+        env.involuntary_switches = it->value("involuntary_switches", 0L);
+        env.warnings =
+            it->value("warnings", std::vector<std::string>());
+        result.setEnvironment(std::move(env));
+      }
+      if (auto it = record.find("counters"); it != record.end()) {
+        std::vector<ZCounter> counters;
+        for (const auto &counter : *it)
+          counters.push_back(
+              {counter.value("name", ""), counter.value("value", 0.0),
+               static_cast<ZCounterKind>(counter.value("kind", 1))});
+        result.setCounters(std::move(counters));
+      }
+      if (auto it = record.find("cold_start"); it != record.end()) {
+        ZColdStartSummary cold;
+        cold.parallel = it->value("parallel", size_t(1));
+        cold.failed = it->value("failed", size_t(0));
+        for (const auto &m : it->value("metrics", json::array()))
+          cold.metrics.push_back(
+              {m.at(0).get<std::string>(), m.at(1).get<double>(),
+               m.at(2).get<uint64_t>(), m.at(3).get<uint64_t>(),
+               m.at(4).get<uint64_t>(), m.at(5).get<uint64_t>(),
+               m.at(6).get<uint64_t>()});
+        for (const auto &c : it->value("samples", json::array()))
+          cold.samples.push_back(
+              {c.at(0).get<int>(), c.at(1).get<double>(), c.at(2).get<double>(),
+               c.at(3).get<double>(), c.at(4).get<long>(), c.at(5).get<long>(),
+               c.at(6).get<long>(), c.at(7).get<long>()});
+        result.setColdStart(std::move(cold));
+      }
+      if (auto it = record.find("load"); it != record.end()) {
+        ZLoadSummary load;
+        load.knee_rate = it->value("knee_rate", 0.0);
+        load.mean_ns = it->value("mean_ns", 0.0);
+        load.saturation = it->value("saturation", "");
+        for (const auto &p : it->value("points", json::array()))
+          load.points.push_back(
+              {p.value("target_rate", 0.0), p.value("achieved_rate", 0.0),
+               p.value("requests", uint64_t(0)), p.value("mean_ns", 0.0),
+               p.value("p50_ns", uint64_t(0)), p.value("p90_ns", uint64_t(0)),
+               p.value("p99_ns", uint64_t(0)), p.value("p999_ns", uint64_t(0)),
+               p.value("max_ns", uint64_t(0)), p.value("saturated", false)});
+        result.setLoad(std::move(load));
+      }
+      if (auto it = record.find("soak"); it != record.end()) {
+        const auto trend = [](const json &t) {
+          return ZTrend{t.value("z", 0.0), t.value("p_value", 1.0),
+                        t.value("slope", 0.0), t.value("increasing", false)};
+        };
+        ZSoakSummary soak;
+        soak.duration_s = it->value("duration_s", 0.0);
+        soak.iterations = it->value("iterations", uint64_t(0));
+        soak.mean_ns = it->value("mean_ns", 0.0);
+        soak.p50_ns = it->value("p50_ns", uint64_t(0));
+        soak.p90_ns = it->value("p90_ns", uint64_t(0));
+        soak.p99_ns = it->value("p99_ns", uint64_t(0));
+        soak.p999_ns = it->value("p999_ns", uint64_t(0));
+        soak.max_ns = it->value("max_ns", uint64_t(0));
+        soak.rss_trend = trend(it->value("rss_trend", json::object()));
+        soak.latency_trend = trend(it->value("latency_trend", json::object()));
+        soak.warnings = it->value("warnings", std::vector<std::string>());
+        // 窗口按 [t_s, count, mean_ns, p50_ns, p99_ns, max_ns, rss_kb] 紧凑存储
+        for (const auto &w : it->value("windows", json::array()))
+          if (w.size() == 7)
+            soak.windows.push_back({w[0].get<double>(), w[1].get<uint64_t>(),
+                                    w[2].get<double>(), w[3].get<uint64_t>(),
+                                    w[4].get<uint64_t>(), w[5].get<uint64_t>(),
+                                    w[6].get<double>()});
+        result.setSoak(std::move(soak));
+      }
+      if (auto it = record.find("scaling"); it != record.end()) {
+        std::vector<ZScalingPoint> scaling;
+        for (const auto &point : *it)
+          scaling.push_back({point.value("threads", size_t(1)),
+                             point.value("wall_ms", 0.0),
+                             point.value("throughput", 0.0),
+                             point.value("speedup", 1.0),
+                             point.value("efficiency", 1.0),
+                             point.value("thread_ms", std::vector<double>())});
+        result.setScaling(std::move(scaling));
+      }
+      result.setFixtureTime(record.value("fixture_ms", 0.0));
+      ZTestResultManager::getInstance().addResult(result);
+      ++count;
+    }
+    logger.info("Replayed " + std::to_string(count) + " results from " + path);
+    return count;
+  }
+
+private:
+  ZResultStream() = default;
+  ~ZResultStream() { closeLocked(); }
+
+  void writeLocked(const std::string &text) {
+    const char *data = text.data();
+    size_t remaining = text.size();
+    while (remaining > 0) {
+      ssize_t written = ::write(_fd, data, remaining);
+      if (written < 0) {
+        if (errno == EINTR)
+          continue;
+        logger.error("Failed to write result stream " + _path + ": " +
+                     std::strerror(errno));
+        break;
+      }
+      data += written;
+      remaining -= static_cast<size_t>(written);
+    }
+  }
+  void syncLocked() {
+    ::fdatasync(_fd);
+    _last_sync = steady_clock::now();
+  }
+
+  void closeLocked() {
+    if (_fd < 0)
+      return;
+    syncLocked();
+    ::close(_fd);
+    _fd = -1;
+  }
+
+  std::mutex _mutex;
+  int _fd = -1;
+  std::string _path;
+  std::chrono::milliseconds _sync_interval{1000};
+  steady_clock::time_point _last_sync;
+};
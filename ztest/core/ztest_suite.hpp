@@ -3,20 +3,32 @@
 #include "ztest_context.hpp"
 #include "ztest_registry.hpp"
 #include "ztest_result.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
 // ZTestSuite 成组的测试
+// 子测试的结果按各自的名称记录，套件的结果为汇总。声明 parallel() 后
+// 子测试以 fork-join 的方式在共享线程池上并行运行；beforeAll 仍在所有子测试之前
+// （由上下文在 run 之前调用），afterEach 在每个子测试结束后串行调用。
 class ZTestSuite : public ZTestBase {
 private:
   vector<unique_ptr<ZTestBase>> _sub_tests;
   vector<ZTestResult> _results;
-  double _total_duration;
-  int _passed;
-  int _failed;
+  vector<ZTestResult> _nested_results; // 嵌套套件的子测试结果
+  double _total_duration = 0.0;
+  int _passed = 0;
+  int _failed = 0;
+  bool _parallel = false;
+  mutex _hook_mutex;
 
 public:
   ZTestSuite(string name, ZType type, string description)
       : ZTestBase(name, type, description) {}
   ZTestSuite(const ZTestSuite &other)
-      : ZTestBase(other.getName(), other.getType(), other.getDescription()) {
+      : ZTestBase(other.getName(), other.getType(), other.getDescription()),
+        _parallel(other._parallel) {
     for (auto &&test : other._sub_tests) {
       if (test) {
         _sub_tests.push_back(test->clone());
@@ -41,6 +53,16 @@ public:
     addBeforeAll(move(hook));
     return *this;
   }
+  /**
+   * @description: 声明子测试之间相互独立，可以并行运行
+   * @param enabled 是否并行
+   * @return 当前测试套件的引用
+   */
+  ZTestSuite &parallel(bool enabled = true) {
+    _parallel = enabled;
+    return *this;
+  }
+  bool isParallel() const { return _parallel; }
 
   template <typename T> ZTestSuite &addTest(T &&test) {
     _sub_tests.push_back(forward<T>(test));
@@ -49,33 +71,56 @@ public:
 
   /**
    * @description: 执行测试套件中的所有子测试用例
-   * @return 测试套件的执行状态（成功或失败）
+   * @return 测试套件的执行状态（成功或失败），有子测试失败时抛出异常
    */
   ZState run() override {
-    _total_duration = 0.0;
+    _results.assign(_sub_tests.size(), ZTestResult());
+    _nested_results.clear();
     _passed = _failed = 0;
     ZTimer suite_timer;
     suite_timer.start();
-    for (auto &test : _sub_tests) {
-      ZTimer case_timer;
-      case_timer.start();
-      ZState result = test->run();
-      case_timer.stop();
-      runAfterEach();
-
-      ZTestResult test_result;
-      test_result.setResult(getName(), test->getType(), result, "",
-                            case_timer.getStartTime(), case_timer.getEndTime(),
-                            case_timer.getElapsedMilliseconds());
-      _results.push_back(test_result);
-
-      (result == ZState::z_success) ? ++_passed : ++_failed;
+    if (_parallel && _sub_tests.size() > 1) {
+      runChildrenParallel();
+    } else {
+      for (size_t i = 0; i < _sub_tests.size(); ++i)
+        runChild(i);
     }
     suite_timer.stop();
     _total_duration = suite_timer.getElapsedMilliseconds();
+
+    vector<string> failed_names;
+    for (const auto &result : _results) {
+      if (result.getState() == ZState::z_success) {
+        ++_passed;
+      } else {
+        ++_failed;
+        failed_names.push_back(result.getName());
+      }
+    }
     setState(_failed == 0 ? ZState::z_success : ZState::z_failed);
+    if (_failed > 0) {
+      string names;
+      for (const auto &name : failed_names)
+        names += (names.empty() ? "" : ", ") + name;
+      throw ZTestFailureException(
+          getName(), "all " + to_string(_sub_tests.size()) + " sub-tests pass",
+          to_string(_failed) + " failed: " + names);
+    }
     return getState();
   }
+  /**
+   * @description: 交出本次运行的子测试结果
+   */
+  void takeChildResults(vector<ZTestResult> &out) override {
+    for (auto &result : _results)
+      out.push_back(move(result));
+    for (auto &result : _nested_results)
+      out.push_back(move(result));
+    _results.clear();
+    _nested_results.clear();
+  }
+  // 子测试的结果只在实际运行后通过 takeChildResults 交出，缓存命中时会丢失
+  bool cacheable() const override { return false; }
   unique_ptr<ZTestBase> clone() const override {
     auto cloned = make_unique<ZTestSuite>(*this);
     return cloned;
@@ -90,6 +135,90 @@ public:
         << "Total Duration: " << _total_duration << "ms\n";
     return oss.str();
   }
+
+private:
+  // 并行运行的子测试由线程按序号领取，全部完成时通知等待的套件线程
+  struct ChildClaims {
+    atomic<size_t> next{0};
+    size_t done = 0;
+    exception_ptr error; // 子测试之外（如 afterEach 钩子）抛出的首个异常
+    mutex guard;
+    condition_variable finished;
+  };
+  /**
+   * @description: 在线程池上并行运行子测试。套件线程自己也领取子测试，
+   *               只等待已被领取的子测试完成，不代为执行队列中的其它测试，
+   *               套件的耗时因此只包含自己的子测试；线程池被占满时也不会死锁
+   */
+  void runChildrenParallel() {
+    // 在工作线程上时使用其所在的线程池
+    ZThreadPool *pool = ZThreadPool::current();
+    if (!pool)
+      pool = &ZThreadPool::shared();
+    const size_t count = _sub_tests.size();
+    auto claims = make_shared<ChildClaims>();
+    // 排队的任务可能在套件返回后才开始，此时已无可领取的子测试，不再访问套件
+    auto work = [this, claims, count] {
+      for (size_t i; (i = claims->next++) < count;) {
+        exception_ptr error;
+        try {
+          runChild(i);
+        } catch (...) {
+          error = current_exception();
+        }
+        lock_guard<mutex> lock(claims->guard);
+        if (error && !claims->error)
+          claims->error = error;
+        if (++claims->done == count)
+          claims->finished.notify_all();
+      }
+    };
+    for (size_t i = 1; i < count; ++i)
+      pool->enqueue(work);
+    work();
+    unique_lock<mutex> lock(claims->guard);
+    claims->finished.wait(lock, [&] { return claims->done == count; });
+    if (claims->error)
+      rethrow_exception(claims->error);
+  }
+  /**
+   * @description: 运行第 index 个子测试，结果写入 _results[index]
+   */
+  void runChild(size_t index) {
+    auto &test = _sub_tests[index];
+    ZAssertScope asserts(*test);
+    ZTimer case_timer;
+    ZState state = ZState::z_failed;
+    string message;
+    vector<ZTestFailure> failures;
+    case_timer.start();
+    try {
+      state = asserts.finalState(test->run());
+      message = asserts.message();
+      failures = asserts.failures();
+    } catch (const exception &e) {
+      message = asserts.message(e.what());
+      failures = asserts.failures(e.what());
+    } catch (...) {
+      message = asserts.message("unknown exception");
+      failures = asserts.failures("unknown exception");
+    }
+    case_timer.stop();
+    {
+      lock_guard<mutex> lock(_hook_mutex);
+      runAfterEach();
+      test->takeChildResults(_nested_results);
+    }
+
+    ZTestResult &result = _results[index];
+    result.setResult(test->getName(), test->getType(), state, message,
+                     case_timer.getStartTime(), case_timer.getEndTime(),
+                     case_timer.getElapsedMilliseconds());
+    result.setFailures(move(failures));
+    if (const double elapsed = ZFixture::takeBuildTime(*test); elapsed > 0)
+      result.separateFixtureTime(elapsed);
+    test->annotateResult(result);
+  }
 };
 // 构建器模式的实现类，用于方便地创建和配置测试套件
 class SuiteBuilder {
@@ -125,6 +254,15 @@ public:
     _suite->addAfterEach(std::move(hook));
     return *this;
   }
+  /**
+   * @description: 声明子测试可以并行运行
+   * @param enabled 是否并行
+   * @return 当前构建器的引用
+   */
+  SuiteBuilder &parallel(bool enabled = true) {
+    _suite->parallel(enabled);
+    return *this;
+  }
   /**
    * @description: 将测试套件注册到测试注册表
    * @return 当前构建器的引用
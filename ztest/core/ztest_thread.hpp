@@ -1,7 +1,11 @@
 #pragma once
+#include "ztest_affinity.hpp"
 #include "ztest_logger.hpp"
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <future>
 #include <queue>
 #include <sstream>
@@ -21,13 +25,22 @@ private:
   std::atomic<bool> stop{false};
 
 public:
-  explicit ZThreadPool(size_t threads) {
+  /**
+   * @description: 创建线程池
+   * @param threads 线程数
+   * @param on_start 每个工作线程启动时以其序号调用，如设置亲和性
+   */
+  explicit ZThreadPool(size_t threads,
+                       std::function<void(size_t)> on_start = nullptr) {
     for (size_t i = 0; i < threads; ++i) {
-      workers.emplace_back([this, i] {
+      workers.emplace_back([this, i, on_start] {
+        if (on_start)
+          on_start(i);
         {
           std::lock_guard<std::mutex> lock(queue_mutex);
           _worker_ids.push_back(std::this_thread::get_id());
         }
+        current() = this;
 
         logger.debug("Worker " + std::to_string(i) + " started (TID: " +
                      thread_id_to_string(std::this_thread::get_id()) + ")");
@@ -89,6 +102,57 @@ public:
     condition.notify_one();
     return res;
   }
+  /**
+   * @description: 在调用线程上执行一个排队中的任务
+   * @return 队列为空时返回false
+   */
+  bool runPendingTask() {
+    std::function<void()> task;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      if (tasks.empty())
+        return false;
+      task = std::move(tasks.front());
+      tasks.pop();
+    }
+    task();
+    _completed_tasks++;
+    return true;
+  }
+  /**
+   * @description: 等待任务完成，等待期间代为执行排队的任务；
+   *               工作线程上的嵌套 fork-join 因此不会占满线程池而死锁
+   * @param future 要等待的任务
+   * @return 任务的结果
+   */
+  template <class T> T join(std::future<T> &future) {
+    while (future.wait_for(std::chrono::seconds(0)) !=
+           std::future_status::ready) {
+      if (!runPendingTask()) {
+        future.wait();
+        break;
+      }
+    }
+    return future.get();
+  }
+  /**
+   * @description: 获取当前线程所属的线程池，非工作线程上为空
+   */
+  static ZThreadPool *&current() {
+    thread_local ZThreadPool *pool = nullptr;
+    return pool;
+  }
+  /**
+   * @description: 获取共享线程池，safe 测试和并行套件的子测试都在其上运行；
+   *               线程数和亲和性取自首次使用时的 ZAffinity::options()
+   */
+  static ZThreadPool &shared() {
+    static ZThreadPool pool(ZAffinity::workerCount(), ZAffinity::applyWorker);
+    return pool;
+  }
+
+  size_t size() const { return workers.size(); }
+
   ~ZThreadPool() {
     stop.store(true);
     condition.notify_all();
@@ -129,4 +193,38 @@ public:
    * @return 已停止返回true，否则返回false
    */
   bool is_stopped() const { return stop.load(); }
-};
\ No newline at end of file
+};
+
+// 自旋屏障：所有参与者到齐后同时放行，用于多线程基准测试的同步起跑。
+// 等待期间自旋，放行延迟远小于条件变量；线程数超过 CPU 数时自旋过久会让出 CPU。
+// 可重复使用。
+class ZSpinBarrier {
+public:
+  explicit ZSpinBarrier(size_t count) : _count(count), _waiting(count) {}
+  void arriveAndWait() {
+    const size_t generation = _generation.load(std::memory_order_acquire);
+    if (_waiting.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      _waiting.store(_count, std::memory_order_relaxed);
+      _generation.fetch_add(1, std::memory_order_release);
+      return;
+    }
+    for (size_t spins = 0;
+         _generation.load(std::memory_order_acquire) == generation; ++spins) {
+      if (spins >= kSpinLimit) {
+        std::this_thread::yield();
+        continue;
+      }
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#elif defined(__aarch64__)
+      asm volatile("yield");
+#endif
+    }
+  }
+
+private:
+  static constexpr size_t kSpinLimit = 1 << 16;
+  const size_t _count;
+  std::atomic<size_t> _waiting;
+  std::atomic<size_t> _generation{0};
+};
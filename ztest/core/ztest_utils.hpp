@@ -1,5 +1,7 @@
 // ztest_utils.hpp
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <curl/curl.h>
 #include <fstream>
 #include <iostream>
@@ -218,12 +220,16 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb,
  * @param api_key API密钥
  * @param model 模型名称，默认为"qwen-turbo"
  * @param temperature 温度参数，默认为0.7
+ * @param timeout_ms 请求超时（毫秒），等于0时不限制
+ * @param cancel 非空且被置为 true 时中止正在进行的请求
  * @return API返回的文本内容或错误信息
  */
 inline std::string call_qwen_api(const std::string &prompt,
                                  const std::string &api_key,
                                  const std::string &model = "qwen-turbo",
-                                 double temperature = 0.7) {
+                                 double temperature = 0.7,
+                                 long timeout_ms = 0,
+                                 const std::atomic<bool> *cancel = nullptr) {
   CURL *curl;
   CURLcode res;
   std::string response_string;
@@ -255,6 +261,21 @@ inline std::string call_qwen_api(const std::string &prompt,
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_string);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "libcurl-agent/1.0");
+    if (timeout_ms > 0) {
+      curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+      curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    }
+    if (cancel) {
+      // 传输期间 curl 周期性调用进度回调，返回非0时中止
+      curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+      curl_easy_setopt(curl, CURLOPT_XFERINFODATA, cancel);
+      curl_easy_setopt(
+          curl, CURLOPT_XFERINFOFUNCTION,
+          +[](void *flag, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+            return static_cast<const std::atomic<bool> *>(flag)->load() ? 1
+                                                                         : 0;
+          });
+    }
 
     // 执行请求
     res = curl_easy_perform(curl);
@@ -316,4 +337,52 @@ inline std::string getApiKey() {
     throw std::runtime_error("API key not found in environment variables");
   }
   return key;
-}
\ No newline at end of file
+}
+/**
+ * @description: 计算FNV-1a 64位哈希，可通过seed串联多段数据
+ * @param data 数据指针
+ * @param size 数据长度
+ * @param seed 初始哈希值
+ * @return 64位哈希值
+ */
+inline uint64_t fnv1a64(const void *data, size_t size,
+                        uint64_t seed = 14695981039346656037ull) {
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  uint64_t hash = seed;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+inline uint64_t fnv1a64(const std::string &s,
+                        uint64_t seed = 14695981039346656037ull) {
+  return fnv1a64(s.data(), s.size(), seed);
+}
+/**
+ * @description: 计算文件内容的哈希
+ * @param path 文件路径
+ * @return 文件内容的哈希值，文件不存在时返回0
+ */
+inline uint64_t hashFileContent(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return 0;
+  uint64_t hash = 14695981039346656037ull;
+  char buffer[64 * 1024];
+  while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+    hash = fnv1a64(buffer, static_cast<size_t>(file.gcount()), hash);
+  }
+  return hash;
+}
+/**
+ * @description: 将哈希值格式化为16位十六进制字符串
+ * @param hash 哈希值
+ * @return 十六进制字符串
+ */
+inline std::string hashToHex(uint64_t hash) {
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx",
+           static_cast<unsigned long long>(hash));
+  return buffer;
+}
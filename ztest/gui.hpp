@@ -2,16 +2,30 @@
 #include <glad/glad.h>
 
 // #include "./lib/implot/implot.h"
+#include "core/ztest_ai.hpp"
+#include "core/ztest_assert.hpp"
 #include "core/ztest_base.hpp"
 #include "core/ztest_benchmark.hpp"
+#include "core/ztest_cluster.hpp"
+#include "core/ztest_coldstart.hpp"
 #include "core/ztest_context.hpp"
+#include "core/ztest_columnar.hpp"
 #include "core/ztest_dataregistry.hpp"
 #include "core/ztest_error.hpp"
+#include "core/ztest_fixture.hpp"
+#include "core/ztest_fuzz.hpp"
+#include "core/ztest_load.hpp"
 #include "core/ztest_macros.hpp"
 #include "core/ztest_parameterized.hpp"
+#include "core/ztest_prefetch.hpp"
+#include "core/ztest_property.hpp"
 #include "core/ztest_registry.hpp"
+#include "core/ztest_report.hpp"
 #include "core/ztest_result.hpp"
+#include "core/ztest_scheduler.hpp"
 #include "core/ztest_singlecase.hpp"
+#include "core/ztest_snapshot.hpp"
+#include "core/ztest_stream.hpp"
 #include "core/ztest_suite.hpp"
 #include "core/ztest_timer.hpp"
 #include "core/ztest_types.hpp"
@@ -22,6 +36,9 @@
 #include "implot.h"
 #include "lib/imgui_markdown/imgui_markdown.h"
 #include <GLFW/glfw3.h>
+#include <charconv>
+#include <cmath>
+#include <limits>
 #include <map>
 // MVC 架构中的模型层，管理测试状态和数据。
 class ZTestModel {
@@ -189,12 +206,24 @@ public:
     while (_memory_history.size() > maxHistorySize)
       _memory_history.pop();
 
+    const ZFuzzStats fuzz = ZFuzzMonitor::instance().snapshot();
+    if (fuzz.active) {
+      _fuzz_execs_history.push(static_cast<float>(fuzz.execs_per_sec));
+      _fuzz_coverage_history.push(static_cast<float>(fuzz.coverage));
+      while (_fuzz_execs_history.size() > maxHistorySize)
+        _fuzz_execs_history.pop();
+      while (_fuzz_coverage_history.size() > maxHistorySize)
+        _fuzz_coverage_history.pop();
+    }
+
     _last_update = now;
   }
 
 private:
   std::queue<float> _cpu_history;
   std::queue<float> _memory_history;
+  std::queue<float> _fuzz_execs_history;    // 模糊测试每秒执行次数
+  std::queue<float> _fuzz_coverage_history; // 模糊测试覆盖率增长
   const size_t maxHistorySize = 60;
   bool _enable_monitoring = true;
   bool show_ai_window = false;
@@ -281,6 +310,13 @@ private:
       if (ImGui::BeginMenu("Options")) {
         ImGui::MenuItem("Enable Resource Monitoring", "", &_enable_monitoring);
         ImGui::MenuItem("Show AI helper", "", &show_ai_window);
+        bool use_cache = ZResultCache::instance().isEnabled();
+        if (ImGui::MenuItem("Use Result Cache", "", &use_cache)) {
+          if (use_cache)
+            ZResultCache::instance().enable();
+          else
+            ZResultCache::instance().disable();
+        }
 
         ImGui::EndMenu();
       }
@@ -293,8 +329,11 @@ private:
     std::vector<float> cpuData = queueToVector(_cpu_history);
     std::vector<float> memoryData = queueToVector(_memory_history);
 
+    const ZFuzzStats fuzz = ZFuzzMonitor::instance().snapshot();
+    const bool showFuzz = !_fuzz_execs_history.empty();
+
     ImVec2 contentSize = ImGui::GetContentRegionAvail();
-    const float plotHeight = contentSize.y * 1.0f;
+    const float plotHeight = contentSize.y * (showFuzz ? 0.45f : 1.0f);
 
     const float totalWidth = contentSize.x * 0.8f;
     const float plotWidth = totalWidth / 2 - ImGui::GetStyle().ItemSpacing.x;
@@ -320,6 +359,34 @@ private:
       ImPlot::EndPlot();
     }
 
+    if (showFuzz) {
+      std::vector<float> execsData = queueToVector(_fuzz_execs_history);
+      std::vector<float> coverageData = queueToVector(_fuzz_coverage_history);
+      ImGui::Text("Fuzz %s%s: %llu execs, corpus %zu, crashes %zu",
+                  fuzz.target.c_str(), fuzz.active ? "" : " (done)",
+                  static_cast<unsigned long long>(fuzz.execs), fuzz.corpus,
+                  fuzz.crashes);
+      const float fuzzHeight = ImGui::GetContentRegionAvail().y;
+
+      if (ImPlot::BeginPlot("##FuzzExecs", ImVec2(plotWidth, fuzzHeight))) {
+        ImPlot::SetupAxes("Time", "Execs/s", 0, ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxisLimits(ImAxis_X1, 0, maxHistorySize, ImPlotCond_Always);
+        ImPlot::SetNextLineStyle(ImVec4(0.9f, 0.2f, 0.6f, 1.0f), 2.0f);
+        ImPlot::PlotLine("Execs/s", execsData.data(), execsData.size());
+        ImPlot::EndPlot();
+      }
+
+      ImGui::SameLine();
+
+      if (ImPlot::BeginPlot("##FuzzCoverage", ImVec2(plotWidth, fuzzHeight))) {
+        ImPlot::SetupAxes("Time", "Edges", 0, ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxisLimits(ImAxis_X1, 0, maxHistorySize, ImPlotCond_Always);
+        ImPlot::SetNextLineStyle(ImVec4(0.2f, 0.8f, 0.3f, 1.0f), 2.0f);
+        ImPlot::PlotLine("Coverage", coverageData.data(), coverageData.size());
+        ImPlot::EndPlot();
+      }
+    }
+
     ImGui::EndGroup();
     ImGui::End();
   }
@@ -410,9 +477,19 @@ private:
 
             oss << "Prompt: " << prompt;
 
-            ai_response = call_qwen_api(
-                oss.str() + "The result should be in commonmark format.",
-                getApiKey());
+            ZAIRequest request;
+            request.prompt =
+                oss.str() + "The result should be in commonmark format.";
+            request.summary.add(test_result, 1);
+            if (test_result.getState() == ZState::z_failed)
+              request.failures.push_back(
+                  {ZFailureClusters::signature(test_result.getName(),
+                                               test_result.getErrorMsg()),
+                   ZFailureClusters::normalize(test_result.getName(),
+                                               test_result.getErrorMsg()),
+                   test_result.getErrorMsg(),
+                   {test_result.getName()}});
+            ai_response = ZAIAnalyzer::instance().analyze(std::move(request));
 
           } catch (const std::exception &e) {
             error_message = std::string("Error: ") + e.what();
@@ -580,6 +657,8 @@ private:
       suiteMap[suiteName].push_back(test);
     }
 
+    renderFailureGroups(model);
+
     ImGui::PushStyleVar(ImGuiStyleVar_CellPadding, {8, 4});
     ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, {4, 4});
 
@@ -641,10 +720,11 @@ private:
               }
 
               ImGui::TableSetColumnIndex(1);
-              ImGui::TextColored(getStateColor(test.getState()), "%s",
+              ImGui::TextColored(getStateColor(test.getState()), "%s%s",
                                  test.getState() == ZState::z_unknown
                                      ? "Not Run"
-                                     : toString(test.getState()));
+                                     : toString(test.getState()),
+                                 test.isCached() ? " (cached)" : "");
 
               ImGui::TableSetColumnIndex(2);
               ImGui::Text("%.2f", test.getUsedTime());
@@ -659,6 +739,46 @@ private:
     ImGui::PopStyleVar(2);
     ImGui::End();
   }
+  /**
+   * @description: 渲染按错误特征分组的失败，点击分组选中其第一个测试
+   * @param model 测试模型引用
+   */
+  void renderFailureGroups(ZTestModel &model) {
+    const auto buckets = ZTestResultManager::getInstance().getFailureBuckets();
+    if (buckets.empty())
+      return;
+    std::string header =
+        "Failure Groups (" + std::to_string(buckets.size()) + ")###FailureGroups";
+    ImGui::PushStyleColor(ImGuiCol_Header, ImVec4(0.4f, 0.0f, 0.0f, 0.3f));
+    if (ImGui::CollapsingHeader(header.c_str())) {
+      for (size_t i = 0; i < buckets.size(); ++i) {
+        const auto &bucket = buckets[i];
+        std::string label = "[" + std::to_string(bucket.count()) + "] " +
+                            bucket.pattern.substr(0, bucket.pattern.find('\n'));
+        if (bucket.pattern.find('\n') != std::string::npos)
+          label += " ...";
+        label += "##bucket" + std::to_string(i);
+        if (ImGui::Selectable(label.c_str(),
+                              bucket.tests.count(model._selected_test) > 0))
+          model._selected_test = *bucket.tests.begin();
+        if (ImGui::IsItemHovered()) {
+          ImGui::BeginTooltip();
+          ImGui::TextUnformatted(bucket.example.c_str());
+          ImGui::Separator();
+          size_t shown = 0;
+          for (const auto &name : bucket.tests) {
+            if (shown++ == 10) {
+              ImGui::TextDisabled("... and %zu more", bucket.count() - 10);
+              break;
+            }
+            ImGui::BulletText("%s", name.c_str());
+          }
+          ImGui::EndTooltip();
+        }
+      }
+    }
+    ImGui::PopStyleColor();
+  }
   void renderTestCaseRow(const ZTestResult &test, ZTestModel &model) {
     // 添加缩进
     ImGui::Indent(10.0f);
@@ -753,12 +873,219 @@ private:
                          toString(it.getState()));
       ImGui::Text("Total Time: %.2f ms", it.getUsedTime());
       ImGui::Text("Average Time: %.6f ms", it.getAverageTime());
-      ImGui::Text("Iterations: %d", it.getIterations());
+      ImGui::Text("Iterations: %llu",
+                  static_cast<unsigned long long>(it.getIterations()));
+      if (it.getFixtureTime() > 0)
+        ImGui::Text("Fixture Build Time: %.2f ms (not included above)",
+                    it.getFixtureTime());
+      if (it.isCached())
+        ImGui::TextDisabled("Result reused from cache");
+      if (const auto &property = it.getProperty()) {
+        ImGui::Text("Property Seed: %llu  Cases: %zu",
+                    static_cast<unsigned long long>(property->seed),
+                    property->cases);
+        if (!property->counterexample.empty()) {
+          ImGui::TextWrapped("Counterexample: %s",
+                             property->counterexample.c_str());
+          ImGui::TextDisabled("Shrunk %zu times from %s", property->shrinks,
+                              property->original.c_str());
+        }
+      }
+      if (it.getState() == ZState::z_failed) {
+        uint64_t signature =
+            ZFailureClusters::signature(it.getName(), it.getErrorMsg());
+        for (const auto &bucket :
+             ZTestResultManager::getInstance().getFailureBuckets()) {
+          if (bucket.signature == signature && bucket.count() > 1) {
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f),
+                               "Same failure as %zu other tests",
+                               bucket.count() - 1);
+            break;
+          }
+        }
+        const auto &failures = it.getFailures();
+        if (failures.size() > 1) {
+          ImGui::Text("%zu failed checks:", failures.size());
+          for (const auto &failure : failures) {
+            ImGui::Separator();
+            if (!failure.file.empty())
+              ImGui::TextColored(failure.fatal ? ImVec4(1, 0.3f, 0.3f, 1)
+                                               : ImVec4(1, 0.6f, 0.2f, 1),
+                                 "%s:%d  %s", failure.file.c_str(),
+                                 failure.line, failure.expression.c_str());
+            ImGui::TextWrapped("%s", failure.message.c_str());
+          }
+        } else {
+          ImGui::TextWrapped("%s", it.getErrorMsg().c_str());
+        }
+      }
+
+      if (const auto &env = it.getEnvironment()) {
+        ImGui::Text("CPU: %d  Governor: %s  Turbo: %s  SMT: %s", env->cpu,
+                    env->governor.empty() ? "-" : env->governor.c_str(),
+                    env->turbo.empty() ? "-" : env->turbo.c_str(),
+                    env->smt_siblings.empty() ? "-"
+                                              : env->smt_siblings.c_str());
+        ImGui::Text("Load: %.2f -> %.2f  Throttling: %llu  Context "
+                    "Switches: %ld voluntary, %ld involuntary",
+                    env->load_before, env->load_after,
+                    static_cast<unsigned long long>(env->throttle_events),
+                    env->voluntary_switches, env->involuntary_switches);
+        for (const auto &warning : env->warnings)
+          ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Noisy: %s",
+                             warning.c_str());
+      }
+
+      for (const auto &counter : it.getCounters()) {
+        // 字节按 1024 进位，其它按 1000 进位
+        const bool bytes = counter.name == "bytes";
+        const double step = bytes ? 1024.0 : 1000.0;
+        const char *const units[] = {"", "k", "M", "G", "T"};
+        const char *const byte_units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+        double value = counter.value;
+        size_t unit = 0;
+        while (std::abs(value) >= step && unit + 1 < std::size(units)) {
+          value /= step;
+          ++unit;
+        }
+        if (counter.kind == ZCounterKind::z_rate)
+          ImGui::Text("%s/s: %.2f %s", counter.name.c_str(), value,
+                      bytes ? byte_units[unit] : units[unit]);
+        else
+          ImGui::Text("%s: %.2f%s per iteration", counter.name.c_str(), value,
+                      units[unit]);
+      }
 
       if (it.getType() == ZType::z_benchmark) {
 
+        const auto &scaling = it.getScaling();
+        if (!scaling.empty()) {
+          std::vector<double> threads, speedup, efficiency;
+          for (const auto &point : scaling) {
+            threads.push_back(static_cast<double>(point.threads));
+            speedup.push_back(point.speedup);
+            efficiency.push_back(point.efficiency);
+            double slowest = 0;
+            for (double ms : point.thread_ms)
+              slowest = std::max(slowest, ms);
+            ImGui::Text("%zu threads: %.0f ops/s  speedup %.2fx  efficiency "
+                        "%.0f%%  slowest thread %.2f ms",
+                        point.threads, point.throughput, point.speedup,
+                        point.efficiency * 100.0, slowest);
+          }
+          if (ImPlot::BeginPlot("##Scaling", ImVec2(-1, 250))) {
+            ImPlot::SetupAxes("Threads", "Speedup", ImPlotAxisFlags_AutoFit,
+                              ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxis(ImAxis_Y2, "Efficiency",
+                              ImPlotAxisFlags_AuxDefault);
+            ImPlot::SetupAxisLimits(ImAxis_Y2, 0, 1.1, ImPlotCond_Always);
+            ImPlot::PlotLine("Ideal", threads.data(), threads.data(),
+                             threads.size());
+            ImPlot::PlotLine("Speedup", threads.data(), speedup.data(),
+                             speedup.size());
+            ImPlot::SetAxes(ImAxis_X1, ImAxis_Y2);
+            ImPlot::PlotLine("Efficiency", threads.data(), efficiency.data(),
+                             efficiency.size());
+            ImPlot::EndPlot();
+          }
+        }
+
+        if (const auto &cold = it.getColdStart()) {
+          ImGui::Text("Cold start: %zu processes, %zu in parallel, %zu failed",
+                      cold->samples.size(), cold->parallel, cold->failed);
+          for (const auto &metric : cold->metrics) {
+            const bool ns = metric.name.size() > 3 &&
+                            metric.name.compare(metric.name.size() - 3, 3,
+                                                "_ns") == 0;
+            const double scale = ns ? 1e3 : 1.0; // 时间以微秒显示
+            ImGui::Text("%s%s: mean %.1f  p50 %.1f  p90 %.1f  p99 %.1f  max "
+                        "%.1f",
+                        metric.name.c_str(), ns ? " (us)" : "",
+                        metric.mean / scale, metric.p50 / scale,
+                        metric.p90 / scale, metric.p99 / scale,
+                        metric.max / scale);
+          }
+          std::vector<double> first_call;
+          for (const auto &sample : cold->samples)
+            first_call.push_back(sample.first_call_ns / 1e3);
+          if (!first_call.empty() &&
+              ImPlot::BeginPlot("##ColdStart", ImVec2(-1, 250))) {
+            ImPlot::SetupAxes("First call (us)", "Processes",
+                              ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+            ImPlot::PlotHistogram("First call", first_call.data(),
+                                  static_cast<int>(first_call.size()));
+            ImPlot::EndPlot();
+          }
+        }
+
+        if (const auto &load = it.getLoad()) {
+          ImGui::Text("Knee: %.0f req/s  Mean latency: %.1f us%s%s",
+                      load->knee_rate, load->mean_ns / 1e3,
+                      load->saturation.empty() ? "" : "  saturated: ",
+                      load->saturation.c_str());
+          std::vector<double> achieved, p50, p99, p999;
+          for (const auto &point : load->points) {
+            achieved.push_back(point.achieved_rate);
+            p50.push_back(point.p50_ns / 1e3);
+            p99.push_back(point.p99_ns / 1e3);
+            p999.push_back(point.p999_ns / 1e3);
+          }
+          if (!achieved.empty() &&
+              ImPlot::BeginPlot("##LoadLatency", ImVec2(-1, 250))) {
+            ImPlot::SetupAxes("Throughput (req/s)", "Latency (us)",
+                              ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxisScale(ImAxis_Y1, ImPlotScale_Log10);
+            ImPlot::PlotLine("p50", achieved.data(), p50.data(),
+                             achieved.size());
+            ImPlot::PlotLine("p99", achieved.data(), p99.data(),
+                             achieved.size());
+            ImPlot::PlotLine("p99.9", achieved.data(), p999.data(),
+                             achieved.size());
+            if (load->knee_rate > 0)
+              ImPlot::PlotInfLines("Knee", &load->knee_rate, 1);
+            ImPlot::EndPlot();
+          }
+        }
+
+        if (const auto &soak = it.getSoak()) {
+          ImGui::Text("Soak: %.0f s, %llu iterations  p50 %.3f us  p99 %.3f us"
+                      "  p99.9 %.3f us  max %.3f us",
+                      soak->duration_s,
+                      static_cast<unsigned long long>(soak->iterations),
+                      soak->p50_ns / 1e3, soak->p99_ns / 1e3,
+                      soak->p999_ns / 1e3, soak->max_ns / 1e3);
+          ImGui::Text("RSS trend: %+.2f MiB/h (p=%.2g)  Latency trend: %+.3f "
+                      "us/h (p=%.2g)",
+                      soak->rss_trend.slope * 3600.0 / 1024.0,
+                      soak->rss_trend.p_value,
+                      soak->latency_trend.slope * 3600.0 / 1000.0,
+                      soak->latency_trend.p_value);
+          for (const auto &warning : soak->warnings)
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Drift: %s",
+                               warning.c_str());
+          std::vector<double> t, p50, p99, rss;
+          for (const auto &window : soak->windows) {
+            t.push_back(window.t_s);
+            p50.push_back(window.p50_ns / 1e3);
+            p99.push_back(window.p99_ns / 1e3);
+            rss.push_back(window.rss_kb / 1024.0);
+          }
+          if (!t.empty() && ImPlot::BeginPlot("##SoakSeries", ImVec2(-1, 250))) {
+            ImPlot::SetupAxes("Time (s)", "Latency (us)",
+                              ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxis(ImAxis_Y2, "RSS (MiB)",
+                              ImPlotAxisFlags_AuxDefault |
+                                  ImPlotAxisFlags_AutoFit);
+            ImPlot::PlotLine("p50", t.data(), p50.data(), t.size());
+            ImPlot::PlotLine("p99", t.data(), p99.data(), t.size());
+            ImPlot::SetAxes(ImAxis_X1, ImAxis_Y2);
+            ImPlot::PlotLine("RSS", t.data(), rss.data(), t.size());
+            ImPlot::EndPlot();
+          }
+        }
+
         auto benchmarkit = &it;
-        auto durations = benchmarkit->getIterationTimestamps();
+        const auto &durations = benchmarkit->getIterationTimestamps();
         if (!durations.empty()) {
           if (ImPlot::BeginPlot("##IterationTimes", "Iteration", "Time (ms)",
                                 ImVec2(-1, -1))) {
@@ -910,22 +1237,222 @@ inline int showUI() {
 
   return 0;
 }
+/**
+ * @description: 读取数值选项的参数，缺失、不是完整的数字或超出 [min, max]
+ *               时打印用法错误；无符号类型不接受负号
+ * @param args 命令行参数
+ * @param i 选项所在的位置，成功时前移到参数
+ * @param placeholder 用法中的参数名，如 "<n>"
+ * @param min 允许的最小值
+ * @param max 允许的最大值
+ * @param out 成功时写入解析出的值
+ * @return 成功返回true
+ */
+template <typename T>
+inline bool parseCLIValue(const std::vector<std::string> &args, size_t &i,
+                          const char *placeholder, T min, T max, T &out) {
+  const std::string &option = args[i];
+  if (i + 1 >= args.size()) {
+    std::cerr << option << " requires " << placeholder << "\n";
+    return false;
+  }
+  const std::string &text = args[i + 1];
+  T value{};
+  const auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  bool valid = !text.empty() && ec == std::errc() &&
+               end == text.data() + text.size() && value >= min &&
+               value <= max;
+  if constexpr (std::is_floating_point_v<T>)
+    valid = valid && std::isfinite(value);
+  if (!valid) {
+    std::cerr << option << ": invalid value '" << text << "', expected "
+              << placeholder << " between " << min << " and " << max
+              << "\nRun with --help for usage.\n";
+    return false;
+  }
+  out = value;
+  ++i;
+  return true;
+}
 inline int runFromCLI(const std::vector<std::string> &args,
                       ZTestContext &context) {
+  // 时长类选项的上限：一年，换算成 steady_clock 的纳秒也不会溢出
+  constexpr double kMaxSeconds = 365.0 * 24 * 3600;
+  constexpr size_t kMaxThreads = 1024;
   bool runAll = false;
   std::string selectedTest;
 
-  for (const auto &arg : args) {
+  for (size_t i = 0; i < args.size(); ++i) {
+    const auto &arg = args[i];
     if (arg == "--help") {
       std::cout << "Usage: ztest_cli [OPTIONS]\n"
                 << "Options:\n"
                 << "  --help           Show this help\n"
                 << "  --run-all        Run all tests\n"
                 << "  --list-tests     List all tests\n"
-                << "  --no-gui         Run in headless mode\n";
+                << "  --no-gui         Run in headless mode\n"
+                << "  --cache          Skip tests whose cached result is "
+                   "still valid\n"
+                << "  --convert-csv <in.csv> <out.zcol>\n"
+                << "                   Convert a CSV dataset to the columnar "
+                   "format\n"
+                << "  --ai-offline     Use the offline heuristic analysis "
+                   "instead of the Qwen API\n"
+                << "  --ai-timeout <ms>\n"
+                << "                   Give up waiting for AI analysis after "
+                   "<ms> milliseconds\n"
+                << "  --record-asserts Record assertion failures in a "
+                   "per-thread buffer instead of throwing\n"
+                << "  --update-snapshots\n"
+                << "                   Rewrite snapshot files instead of "
+                   "comparing against them\n"
+                << "  --seed <n>       Seed for property tests (printed "
+                   "with every failure)\n"
+                << "  --property-cases <n>\n"
+                << "                   Random cases per property test "
+                   "(default 1000)\n"
+                << "  --fuzz <seconds> Fuzz each ZFUZZ target for <seconds> "
+                   "instead of only replaying its corpus\n"
+                << "  --fuzz-workers <n>\n"
+                << "                   Worker threads per fuzz target "
+                   "(default: hardware threads)\n"
+                << "  --workers <n>    Worker threads for safe tests and "
+                   "parallel suites (default: min(hardware threads, 8))\n"
+                << "  --pin-workers    Pin each worker to one CPU, "
+                   "interleaved across NUMA nodes\n"
+                << "  --bench-core <cpu>\n"
+                << "                   Run benchmarks pinned to <cpu> and "
+                   "keep workers off it\n"
+                << "  --bench-priority Raise scheduling priority while "
+                   "benchmarks run (needs CAP_SYS_NICE)\n"
+                << "  --bench-strict   Fail benchmarks instead of warning "
+                   "when the environment is noisy\n"
+                << "  --soak <seconds> Run each benchmark for <seconds> and "
+                   "check RSS/latency for monotonic drift\n"
+                << "  --load-step <seconds>\n"
+                << "                   Duration of each rate step in load "
+                   "tests (default 1)\n"
+                << "  --load-workers <n>\n"
+                << "                   Threads issuing load-test requests "
+                   "(default: --workers)\n"
+                << "  --cold-start <n> Measure each benchmark in <n> fresh "
+                   "processes (first call, page faults, startup)\n"
+                << "  --cold-start-parallel <n>\n"
+                << "                   Cold-start processes run at once "
+                   "(default: one per physical core)\n"
+                << "  --stream <file>  Append each result to a JSON-lines "
+                   "stream as it completes\n"
+                << "  --rebuild-reports <file>\n"
+                << "                   Rebuild JSON/JUnit reports from a "
+                   "(possibly partial) stream\n";
       return 0;
     } else if (arg == "--run-all") {
       runAll = true;
+    } else if (arg == "--cache") {
+      ZResultCache::instance().enable();
+    } else if (arg == "--convert-csv") {
+      if (i + 2 >= args.size()) {
+        std::cerr << "--convert-csv requires <in.csv> <out.zcol>\n";
+        return 1;
+      }
+      try {
+        ZColumnarConverter::fromCSV(args[i + 1], args[i + 2]);
+      } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+      }
+      return 0;
+    } else if (arg == "--ai-offline") {
+      ZAIAnalyzer::instance().setBackend(
+          std::make_shared<ZHeuristicBackend>());
+    } else if (arg == "--ai-timeout") {
+      long timeout_ms = 0;
+      if (!parseCLIValue(args, i, "<ms>", 0L, 24L * 3600 * 1000, timeout_ms))
+        return 1;
+      ZAIAnalyzer::instance().setTimeout(std::chrono::milliseconds(timeout_ms));
+    } else if (arg == "--record-asserts") {
+      ZAssertBuffer::setMode(ZAssertMode::z_record);
+    } else if (arg == "--update-snapshots") {
+      ZSnapshot::setUpdate(true);
+    } else if (arg == "--seed") {
+      uint64_t seed = 0;
+      if (!parseCLIValue(args, i, "<n>", uint64_t(0),
+                         std::numeric_limits<uint64_t>::max(), seed))
+        return 1;
+      ZPropertyRunner::setSeed(seed);
+    } else if (arg == "--property-cases") {
+      if (!parseCLIValue(args, i, "<n>", size_t(1), size_t(1) << 32,
+                         ZPropertyRunner::defaultConfig().cases))
+        return 1;
+    } else if (arg == "--fuzz") {
+      if (!parseCLIValue(args, i, "<seconds>", 0.0, kMaxSeconds,
+                         ZFuzzTest::options().seconds))
+        return 1;
+    } else if (arg == "--fuzz-workers") {
+      if (!parseCLIValue(args, i, "<n>", size_t(0), kMaxThreads,
+                         ZFuzzTest::options().workers))
+        return 1;
+    } else if (arg == "--workers") {
+      if (!parseCLIValue(args, i, "<n>", size_t(0), kMaxThreads,
+                         ZAffinity::options().workers))
+        return 1;
+    } else if (arg == "--pin-workers") {
+      ZAffinity::options().pin_workers = true;
+    } else if (arg == "--bench-core") {
+      if (!parseCLIValue(args, i, "<cpu>", 0, CPU_SETSIZE - 1,
+                         ZAffinity::options().benchmark_core))
+        return 1;
+    } else if (arg == "--bench-priority") {
+      ZAffinity::options().raise_priority = true;
+    } else if (arg == "--bench-strict") {
+      ZBenchProbe::strict() = true;
+    } else if (arg == "--soak") {
+      if (!parseCLIValue(args, i, "<seconds>", 0.0, kMaxSeconds,
+                         ZBenchMark::soakSeconds()))
+        return 1;
+    } else if (arg == "--load-step") {
+      if (!parseCLIValue(args, i, "<seconds>", 0.001, kMaxSeconds,
+                         ZLoadTest::options().step_seconds))
+        return 1;
+    } else if (arg == "--load-workers") {
+      if (!parseCLIValue(args, i, "<n>", size_t(0), kMaxThreads,
+                         ZLoadTest::options().workers))
+        return 1;
+    } else if (arg == "--cold-start") {
+      if (!parseCLIValue(args, i, "<n>", size_t(0), size_t(1000000),
+                         ZColdStart::options().samples))
+        return 1;
+    } else if (arg == "--cold-start-parallel") {
+      if (!parseCLIValue(args, i, "<n>", size_t(0), kMaxThreads,
+                         ZColdStart::options().parallel))
+        return 1;
+    } else if (arg == ZColdStart::kChildFlag) {
+      if (i + 1 >= args.size())
+        return 2;
+      return ZBenchMark::runColdStartChild(args[i + 1]);
+    } else if (arg == "--stream") {
+      if (i + 1 >= args.size()) {
+        std::cerr << "--stream requires <file>\n";
+        return 1;
+      }
+      if (!ZResultStream::instance().open(args[++i]))
+        return 1;
+    } else if (arg == "--rebuild-reports") {
+      if (i + 1 >= args.size()) {
+        std::cerr << "--rebuild-reports requires <file>\n";
+        return 1;
+      }
+      try {
+        ZResultStream::replay(args[i + 1]);
+      } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+      }
+      ZReportOptions options;
+      options.html = false;
+      ZReportWriter(options).write();
+      return 0;
     } else if (arg == "--list-tests") {
       for (const auto &test : ZTestRegistry::instance().takeTests()) {
         std::cout << test->getName() << "\n";
@@ -939,6 +1466,7 @@ inline int runFromCLI(const std::vector<std::string> &args,
 
   if (runAll) {
     context.runAllTests();
+    context.waitForReports();
   } else if (!selectedTest.empty()) {
     if (!context.runSelectedTest(selectedTest)) {
       std::cerr << "Test not found: " << selectedTest << "\n";